@@ -0,0 +1,320 @@
+#include "AdcAcquisition.h"
+#include "SimulatedAds1263.h"
+#include "Metrics.h"
+#include <pthread.h>
+#include <sched.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+AdcAcquisition::AdcAcquisition() = default;
+
+AdcAcquisition::~AdcAcquisition() {
+    stop();
+}
+
+void AdcAcquisition::setBackend(Backend b) {
+    backend = b;
+}
+
+void AdcAcquisition::setDevice(std::unique_ptr<SpiDevice> customDevice) {
+    device = std::move(customDevice);
+}
+
+void AdcAcquisition::setChannels(int count) {
+    if (count < 1) count = 1;
+    if (count > AdcSample::MAX_CHANNELS) count = AdcSample::MAX_CHANNELS;
+    channels = count;
+}
+
+void AdcAcquisition::setChannelSpec(int channel, const ChannelSpec& spec) {
+    if (channel >= 0 && channel < AdcSample::MAX_CHANNELS)
+        specs[channel] = spec;
+}
+
+void AdcAcquisition::setNoiseFloorUv(double noiseUv) {
+    for (ChannelSpec& spec : specs)
+        spec.noiseUv = noiseUv;
+}
+
+void AdcAcquisition::setAdc2Channels(int count) {
+    forcedAdc2 = count;
+}
+
+void AdcAcquisition::setSink(Sink s) {
+    sink = std::move(s);
+}
+
+AdcAcquisition::Backend AdcAcquisition::backendFromString(const char* name) {
+    if (name && strcmp(name, "sim") == 0) return Backend::Simulated;
+    return Backend::Hardware;
+}
+
+const char* AdcAcquisition::deviceName() const {
+    return device ? device->name() : "none";
+}
+
+bool AdcAcquisition::start() {
+    if (running.load())
+        return true;
+
+    if (!device) {
+        if (backend == Backend::Simulated)
+            device = std::make_unique<SimulatedAds1263>();
+        else
+            device = std::make_unique<LinuxSpiDevice>();
+    }
+    if (!device->open()) {
+        fprintf(stderr, "ADC: cannot open %s device\n", device->name());
+        return false;
+    }
+
+    scanPlan = planScan(specs, channels, forcedAdc2);
+    adc1Count = adc2Count = 0;
+    for (int ch = 0; ch < channels; ++ch) {
+        const ChannelPlan& p = scanPlan.plans[ch];
+        (p.onAdc2 ? adc2List[adc2Count++] : adc1List[adc1Count++]) = ch;
+        // Twice the planned visit before calling DRDY lost.
+        timeoutMs[ch] = (int)(2 * p.cycleUs / 1000) + 10;
+        if (p.onAdc2)
+            fprintf(stderr, "ADC ch%d: ADC2 %g SPS, x%d -> %.2f uV RMS%s, %.0f us/visit\n",
+                    ch, Ads1263::adc2RateHz(p.config.drate), p.averages, p.noiseUv,
+                    p.meetsFloor ? "" : " (above floor)", p.cycleUs);
+        else
+            fprintf(stderr, "ADC ch%d: %g SPS, filter 0x%02x, delay %d us, x%d -> %.2f uV RMS%s, %.0f us/visit\n",
+                    ch, Ads1263::dataRateHz(p.config.drate), p.config.filter, Ads1263::delayUs(p.config.delay),
+                    p.averages, p.noiseUv, p.meetsFloor ? "" : " (above floor)", p.cycleUs);
+    }
+    fprintf(stderr, "ADC: planned %.0f samples/s on ADC1 channels, %.0f on ADC2 channels\n",
+            scanPlan.adc1RoundUs > 0 ? 1e6 / scanPlan.adc1RoundUs : 0.0,
+            scanPlan.adc2RoundUs > 0 ? 1e6 / scanPlan.adc2RoundUs : 0.0);
+
+    adc = std::make_unique<Ads1263>(*device);
+    if (!initChip()) {
+        fprintf(stderr, "ADC: ADS1263 init failed on %s device\n", device->name());
+        device->close();
+        return false;
+    }
+
+    running.store(true);
+    worker = std::thread(&AdcAcquisition::run, this);
+    return true;
+}
+
+void AdcAcquisition::stop() {
+    if (!running.exchange(false))
+        return;
+    worker.join();
+    adc->command(Ads1263::CMD_STOP1);
+    adc->command(Ads1263::CMD_STOP2);
+    device->close();
+}
+
+bool AdcAcquisition::initChip() {
+    positioned = false;
+    adc2Pos = adc2Reads = adc2Good = 0;
+    adc2Sum = 0;
+    for (int ch = 0; ch < AdcSample::MAX_CHANNELS; ++ch) {
+        adc2Volts[ch] = std::numeric_limits<double>::quiet_NaN();
+        adc2TimeUs[ch] = 0;
+    }
+    adc2Fresh = 0;
+
+    if (!adc->init(scanPlan.plans[adc1List[0]].config))
+        return false;
+    if (adc2Count == 0)
+        return true;
+    int first = adc2List[0];
+    return adc->selectAdc2DiffChannel(first, scanPlan.plans[first].config.drate) &&
+           adc->command(Ads1263::CMD_START2);
+}
+
+bool AdcAcquisition::latest(AdcSample& out) const {
+    std::lock_guard<std::mutex> lock(latestMutex);
+    if (haveLast)
+        out = last;
+    return haveLast;
+}
+
+AdcAcquisition::Stats AdcAcquisition::stats() const {
+    std::lock_guard<std::mutex> lock(latestMutex);
+    Stats s = counters;
+    if (haveLast && counters.scans > 1 && last.timeUs > firstScanUs) {
+        double seconds = (last.timeUs - firstScanUs) * 1e-6;
+        s.scansPerSecond = (counters.scans - 1) / seconds;
+        for (int ch = 0; ch < channels; ++ch)
+            s.channelRate[ch] = counters.channelSamples[ch] / seconds;
+    }
+    return s;
+}
+
+void AdcAcquisition::bump(uint64_t& counter) {
+    std::lock_guard<std::mutex> lock(latestMutex);
+    ++counter;
+}
+
+void AdcAcquisition::readError() {
+    bump(counters.readErrors);
+    metrics.count(Metrics::Counter::AdcReadErrors);
+}
+
+void AdcAcquisition::serviceAdc2(int64_t timeUs) {
+    const int ch = adc2List[adc2Pos];
+    const ChannelPlan& p = scanPlan.plans[ch];
+    const int nextPos = (adc2Pos + 1) % adc2Count;
+    const int next = adc2List[nextPos];
+    bool lastRead = adc2Reads == p.averages - 1;
+
+    // A lone ADC2 channel keeps converting; switching would restart it.
+    int32_t code = 0;
+    int res = lastRead && adc2Count > 1
+        ? adc->readAdc2AndSelect(code, next, scanPlan.plans[next].config.drate)
+        : adc->readAdc2(code);
+    if (res == 0)
+        return;
+    ++adc2Reads;
+    if (res == 1) {
+        adc2Sum += code;
+        ++adc2Good;
+    } else {
+        readError();
+        if (lastRead && adc2Count > 1)
+            adc->selectAdc2DiffChannel(next, scanPlan.plans[next].config.drate);
+    }
+    if (!lastRead)
+        return;
+
+    adc2Volts[ch] = adc2Good > 0 ? Ads1263::codeToVolts((int32_t)(adc2Sum / adc2Good))
+                                 : std::numeric_limits<double>::quiet_NaN();
+    adc2TimeUs[ch] = timeUs;
+    adc2Fresh |= 1u << ch;
+    adc2Pos = nextPos;
+    adc2Reads = adc2Good = 0;
+    adc2Sum = 0;
+}
+
+bool AdcAcquisition::scan(AdcSample& sample) {
+    sample.count = channels;
+    const ChannelPlan* plans = scanPlan.plans;
+    if (!positioned && !adc->selectDiffChannel(adc1List[0], plans[adc1List[0]].config)) {
+        readError();
+        return false;
+    }
+    positioned = true;
+
+    for (int i = 0; i < adc1Count; ++i) {
+        const int ch = adc1List[i];
+        const ChannelPlan& p = plans[ch];
+        const int next = adc1List[(i + 1) % adc1Count];
+        int64_t sum = 0;
+        int good = 0;
+        int stale = 0;
+        for (int reads = 0; reads < p.averages;) {
+            int64_t edgeUs = 0;
+            int res = device->waitDataReady(timeoutMs[ch], &edgeUs);
+            if (res <= 0) {
+                if (res == 0)
+                    bump(counters.timeouts);
+                else
+                    readError();
+                positioned = false;
+                return false;
+            }
+            if (reads == 0)
+                sample.channelTimeUs[ch] = edgeUs;
+
+            int32_t code = 0;
+            bool lastRead = reads == p.averages - 1;
+            res = lastRead ? adc->readAdc1AndSelect(code, next, plans[next].config) : adc->readAdc1(code);
+            if (adc2Count > 0 && adc->adc2Ready())
+                serviceAdc2(edgeUs);
+            // A late read can pick up a conversion whose edge is still queued;
+            // that edge then finds nothing new. Wait for the next one instead.
+            if (res == 0 && !lastRead && ++stale <= p.averages)
+                continue;
+            ++reads;
+            if (res == 1) {
+                sum += code;
+                ++good;
+            } else if (res < 0) {
+                readError();
+                // A failed frame may not have switched the mux; do it again.
+                if (lastRead && !adc->selectDiffChannel(next, plans[next].config)) {
+                    positioned = false;
+                    return false;
+                }
+            }
+        }
+
+        // NaN never compares over a threshold, as with the old CSV path.
+        sample.volts[ch] = good > 0 ? Ads1263::codeToVolts((int32_t)(sum / good))
+                                    : std::numeric_limits<double>::quiet_NaN();
+        sample.fresh |= 1u << ch;
+    }
+
+    // Merge in ADC2's latest. A held ADC2 value is not new information, so
+    // the sample is only as old as its oldest fresh channel; how stale the
+    // held ones are is kept per channel in Stats instead.
+    for (int i = 0; i < adc2Count; ++i) {
+        const int ch = adc2List[i];
+        sample.volts[ch] = adc2Volts[ch];
+        sample.channelTimeUs[ch] = adc2TimeUs[ch];
+    }
+    sample.fresh |= adc2Fresh;
+    adc2Fresh = 0;
+    sample.timeUs = sample.channelTimeUs[adc1List[0]];
+    for (int ch = 0; ch < channels; ++ch)
+        if ((sample.fresh & (1u << ch)) && sample.channelTimeUs[ch] > 0 && sample.channelTimeUs[ch] < sample.timeUs)
+            sample.timeUs = sample.channelTimeUs[ch];
+    return true;
+}
+
+void AdcAcquisition::run() {
+    // Just below the safety engine, which drains what this thread produces.
+    sched_param param = {};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 30;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+        fprintf(stderr, "ADC: SCHED_FIFO unavailable (%s), using normal priority\n", strerror(err));
+
+    uint64_t seq = 0;
+    int failures = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        AdcSample sample;
+        if (!scan(sample)) {
+            if (++failures >= REINIT_AFTER) {
+                fprintf(stderr, "ADC: %d failed scans, reinitializing\n", failures);
+                initChip();
+                failures = 0;
+                bump(counters.reinits);
+            }
+            continue;
+        }
+        failures = 0;
+        sample.seq = seq++;
+
+        {
+            std::lock_guard<std::mutex> lock(latestMutex);
+            if (firstScanUs < 0)
+                firstScanUs = sample.timeUs;
+            last = sample;
+            haveLast = true;
+            ++counters.scans;
+            // Measured against the scan's last ADC1 conversion.
+            const int64_t scanUs = sample.channelTimeUs[adc1List[adc1Count - 1]];
+            for (int ch = 0; ch < sample.count; ++ch) {
+                if ((sample.fresh & (1u << ch)) && !std::isnan(sample.volts[ch]))
+                    ++counters.channelSamples[ch];
+                if (sample.channelTimeUs[ch] <= 0)
+                    continue;
+                int64_t ageUs = scanUs - sample.channelTimeUs[ch];
+                counters.channelAgeUs[ch] = ageUs;
+                if (ageUs > counters.maxChannelAgeUs[ch])
+                    counters.maxChannelAgeUs[ch] = ageUs;
+            }
+        }
+        if (sink)
+            sink(sample);
+    }
+}
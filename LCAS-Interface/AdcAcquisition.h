@@ -0,0 +1,134 @@
+#ifndef ADC_ACQUISITION_H
+#define ADC_ACQUISITION_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Ads1263.h"
+#include "AdcScanPlan.h"
+#include "SpiDevice.h"
+
+// One scan of the stray-light photodiodes.
+struct AdcSample {
+    static constexpr int MAX_CHANNELS = 4;
+
+    uint64_t seq = 0;
+    int64_t timeUs = 0;     // oldest fresh conversion in the sample (steady clock)
+    int count = 0;
+    double volts[MAX_CHANNELS] = {};    // NaN where a read failed
+    int64_t channelTimeUs[MAX_CHANNELS] = {};
+    unsigned fresh = 0;     // bit per channel converted since the last sample
+};
+
+// Scans the ADS1263 differential inputs on its own thread. The thread sleeps
+// on the DRDY line event between conversions and hands every scan straight
+// to the sink (the safety engine and flight recorder), so the interlock never
+// goes through the GUI thread or a child process. The GUI polls latest().
+//
+// Each channel is converted with its own plan (rate, filter, settling delay,
+// averaging) chosen for its noise floor. The last read on a channel and the
+// switch to the next one share one SPI frame, so a visit costs one frame per
+// conversion and the chip is never idle waiting on the host.
+//
+// When the plan puts channels on ADC2, both converters run at once. ADC2
+// is serviced from the same thread whenever an ADC1 read's status byte
+// shows it has data, and is timestamped with that ADC1 conversion. A sample
+// is emitted per ADC1 round and carries each ADC2 channel's latest value
+// with its own time; the sample time is the oldest of the channels converted
+// in that round, so a held ADC2 value does not count against the latency
+// budget. Stats::channelAgeUs tracks how stale the held values get.
+class AdcAcquisition {
+public:
+    enum class Backend { Hardware, Simulated };
+
+    using Sink = std::function<void(const AdcSample& sample)>;
+
+    struct Stats {
+        uint64_t scans = 0;
+        uint64_t timeouts = 0;      // DRDY never came
+        uint64_t readErrors = 0;    // SPI or checksum failures
+        uint64_t reinits = 0;
+        uint64_t channelSamples[AdcSample::MAX_CHANNELS] = {};
+        double scansPerSecond = 0;
+        double channelRate[AdcSample::MAX_CHANNELS] = {};  // good samples/s
+        // How old each channel's value was in the latest scan, and the worst
+        // seen; non-zero for ADC2 channels, which are held between rounds.
+        int64_t channelAgeUs[AdcSample::MAX_CHANNELS] = {};
+        int64_t maxChannelAgeUs[AdcSample::MAX_CHANNELS] = {};
+    };
+
+    AdcAcquisition();
+    ~AdcAcquisition();
+
+    AdcAcquisition(const AdcAcquisition&) = delete;
+    AdcAcquisition& operator=(const AdcAcquisition&) = delete;
+
+    // Configure before start().
+    void setBackend(Backend backend);
+    void setDevice(std::unique_ptr<SpiDevice> device);  // overrides the backend
+    void setChannels(int count);
+    void setChannelSpec(int channel, const ChannelSpec& spec);
+    void setNoiseFloorUv(double noiseUv);   // every channel
+    void setAdc2Channels(int count);        // highest channels on ADC2; -1 = planner decides
+    void setSink(Sink sink);    // runs on the acquisition thread
+    static Backend backendFromString(const char* name);
+
+    // Opens and initializes the chip, then starts scanning. False if the
+    // device cannot be opened or the chip does not answer.
+    bool start();
+    void stop();
+
+    bool latest(AdcSample& out) const;
+    Stats stats() const;
+    const ScanPlan& plan() const { return scanPlan; }
+    const char* deviceName() const;
+
+private:
+    static constexpr int REINIT_AFTER = 10;     // consecutive failed scans
+
+    Backend backend = Backend::Hardware;
+    std::unique_ptr<SpiDevice> device;
+    std::unique_ptr<Ads1263> adc;
+    ChannelSpec specs[AdcSample::MAX_CHANNELS];
+    ScanPlan scanPlan;
+    int timeoutMs[AdcSample::MAX_CHANNELS] = {};
+    int channels = AdcSample::MAX_CHANNELS;
+    int forcedAdc2 = -1;
+
+    int adc1List[AdcSample::MAX_CHANNELS] = {};
+    int adc1Count = 0;
+    bool positioned = false;    // ADC1 mux already on adc1List[0]
+
+    // ADC2 visits in progress and the latest value per channel.
+    int adc2List[AdcSample::MAX_CHANNELS] = {};
+    int adc2Count = 0;
+    int adc2Pos = 0;
+    int adc2Reads = 0;
+    int adc2Good = 0;
+    int64_t adc2Sum = 0;
+    double adc2Volts[AdcSample::MAX_CHANNELS] = {};
+    int64_t adc2TimeUs[AdcSample::MAX_CHANNELS] = {};
+    unsigned adc2Fresh = 0;
+    Sink sink;
+
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    mutable std::mutex latestMutex;
+    AdcSample last;
+    bool haveLast = false;
+    Stats counters;
+    int64_t firstScanUs = -1;
+
+    bool initChip();
+    void run();
+    bool scan(AdcSample& sample);
+    void serviceAdc2(int64_t timeUs);
+    void bump(uint64_t& counter);    // a counters field, under latestMutex
+    void readError();                // readErrors and the process metrics
+};
+
+#endif // ADC_ACQUISITION_H
@@ -0,0 +1,173 @@
+#include "AdcFilterBank.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double NV_PER_VOLT = 1e9;
+static constexpr double INF = std::numeric_limits<double>::infinity();
+static constexpr double NAN_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+static inline double median3(double a, double b, double c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+static inline double median5(double a, double b, double c, double d, double e) {
+    return median3(c, std::max(std::min(a, b), std::min(d, e)),
+                      std::min(std::max(a, b), std::max(d, e)));
+}
+
+AdcFilterBank::AdcFilterBank() {
+    configure(Config());
+}
+
+AdcFilterBank::AdcFilterBank(const Config& config) {
+    configure(config);
+}
+
+void AdcFilterBank::configure(const Config& config) {
+    cfg = config;
+    cfg.median = cfg.median >= 5 ? 5 : cfg.median >= 3 ? 3 : 1;
+    cfg.cicOrder = std::clamp(cfg.cicOrder, 1, MAX_ORDER);
+    cfg.decimation = std::clamp(cfg.decimation, 1, MAX_DECIMATION);
+    cfg.window = std::clamp(cfg.window, 1, MAX_WINDOW);
+
+    gain = 1;
+    for (int k = 0; k < cfg.cicOrder; ++k)
+        gain *= cfg.decimation;
+    // The impulse response spans order * decimation scans; one more output
+    // period covers the phase the lane was seeded at.
+    warmScans = (cfg.cicOrder + 1) * cfg.decimation;
+    reset();
+}
+
+void AdcFilterBank::reset() {
+    seeded = 0;
+    phase = 0;
+    pos = 0;
+    for (int l = 0; l < LANES; ++l)
+        seedLane(l, 0.0);
+    seeded = 0;
+}
+
+void AdcFilterBank::seedLane(int l, double volts) {
+    // The lane starts as if it had always read `volts`, so the median and
+    // the window do not see a step from zero. Runs once per lane.
+    for (int k = 0; k < MAX_MEDIAN; ++k)
+        median[k][l] = volts;
+    despiked[l] = volts;
+    for (int k = 0; k < MAX_ORDER; ++k)
+        integrators[k][l] = combs[k][l] = 0;
+    warm[l] = 0;
+
+    for (int i = 0; i < cfg.window; ++i)
+        ring[i][l] = suffixMin[i][l] = suffixMax[i][l] = volts;
+    suffixMin[cfg.window][l] = INF;
+    suffixMax[cfg.window][l] = -INF;
+    prefixMin[l] = prefixMax[l] = volts;
+    reference[l] = volts;
+    sum[l] = sumSq[l] = pendingSum[l] = pendingSq[l] = 0.0;
+    seeded |= 1u << l;
+}
+
+bool AdcFilterBank::push(const double* volts, int count, unsigned fresh, Output& out) {
+    double in[LANES];
+    bool take[LANES];
+    for (int l = 0; l < LANES; ++l) {
+        in[l] = l < count ? volts[l] : NAN_VALUE;
+        take[l] = (fresh >> l & 1u) && !std::isnan(in[l]);
+        if (take[l] && !(seeded >> l & 1u))
+            seedLane(l, in[l]);
+    }
+
+    // Median: shift in fresh conversions only.
+    for (int k = cfg.median - 1; k > 0; --k)
+        for (int l = 0; l < LANES; ++l)
+            median[k][l] = take[l] ? median[k - 1][l] : median[k][l];
+    for (int l = 0; l < LANES; ++l)
+        median[0][l] = take[l] ? in[l] : median[0][l];
+    if (cfg.median == 5) {
+        for (int l = 0; l < LANES; ++l)
+            despiked[l] = median5(median[0][l], median[1][l], median[2][l], median[3][l], median[4][l]);
+    } else if (cfg.median == 3) {
+        for (int l = 0; l < LANES; ++l)
+            despiked[l] = median3(median[0][l], median[1][l], median[2][l]);
+    } else {
+        for (int l = 0; l < LANES; ++l)
+            despiked[l] = median[0][l];
+    }
+
+    // CIC integrators at the scan rate; unsigned so wraparound is defined.
+    for (int l = 0; l < LANES; ++l) {
+        integrators[0][l] += (uint64_t)(int64_t)(despiked[l] * NV_PER_VOLT);
+        warm[l] = std::min(warm[l] + 1, warmScans);
+    }
+    for (int k = 1; k < cfg.cicOrder; ++k)
+        for (int l = 0; l < LANES; ++l)
+            integrators[k][l] += integrators[k - 1][l];
+    if (++phase < cfg.decimation)
+        return false;
+    phase = 0;
+
+    // Combs at the output rate.
+    double value[LANES];
+    for (int l = 0; l < LANES; ++l) {
+        uint64_t y = integrators[cfg.cicOrder - 1][l];
+        for (int k = 0; k < cfg.cicOrder; ++k) {
+            uint64_t delayed = combs[k][l];
+            combs[k][l] = y;
+            y -= delayed;
+        }
+        double cic = (double)(int64_t)y / (double)gain / NV_PER_VOLT;
+        value[l] = warm[l] >= warmScans ? cic : despiked[l];
+    }
+
+    // Window statistics.
+    const int w = cfg.window;
+    if (pos == 0) {
+        for (int l = 0; l < LANES; ++l)
+            prefixMin[l] = prefixMax[l] = value[l];
+    } else {
+        for (int l = 0; l < LANES; ++l) {
+            prefixMin[l] = std::min(prefixMin[l], value[l]);
+            prefixMax[l] = std::max(prefixMax[l], value[l]);
+        }
+    }
+    for (int l = 0; l < LANES; ++l) {
+        double x = value[l] - reference[l];
+        double old = ring[pos][l] - reference[l];
+        ring[pos][l] = value[l];
+        sum[l] += x - old;
+        sumSq[l] += x * x - old * old;
+        pendingSum[l] += x;
+        pendingSq[l] += x * x;
+
+        double mean = sum[l] / w;
+        double var = std::max(0.0, sumSq[l] / w - mean * mean);
+        bool valid = seeded >> l & 1u;
+        out.value[l] = valid ? value[l] : NAN_VALUE;
+        out.min[l] = valid ? std::min(prefixMin[l], suffixMin[pos + 1][l]) : NAN_VALUE;
+        out.max[l] = valid ? std::max(prefixMax[l], suffixMax[pos + 1][l]) : NAN_VALUE;
+        out.mean[l] = valid ? reference[l] + mean : NAN_VALUE;
+        out.stddev[l] = valid ? std::sqrt(var) : NAN_VALUE;
+    }
+
+    if (++pos == w) {
+        // The block just filled becomes the suffix half of the next windows.
+        pos = 0;
+        for (int i = w - 1; i >= 0; --i)
+            for (int l = 0; l < LANES; ++l) {
+                suffixMin[i][l] = std::min(ring[i][l], suffixMin[i + 1][l]);
+                suffixMax[i][l] = std::max(ring[i][l], suffixMax[i + 1][l]);
+            }
+        // Re-centre on the window's mean: sum becomes zero and sumSq the
+        // centred sum of squares.
+        for (int l = 0; l < LANES; ++l) {
+            double shift = pendingSum[l] / w;
+            reference[l] += shift;
+            sum[l] = 0.0;
+            sumSq[l] = std::max(0.0, pendingSq[l] - pendingSum[l] * shift);
+            pendingSum[l] = pendingSq[l] = 0.0;
+        }
+    }
+    return true;
+}
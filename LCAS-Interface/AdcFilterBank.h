@@ -0,0 +1,94 @@
+#ifndef ADC_FILTER_BANK_H
+#define ADC_FILTER_BANK_H
+
+#include <cstdint>
+
+// Streaming filters between the stray-light ADC and the trip logic, so a
+// threshold is compared against a sustained signal rather than one
+// conversion. Per channel, in order:
+//
+//   median     rejects single-conversion spikes (1, 3 or 5 conversions)
+//   CIC        order-N integrate/comb decimator, in integer nanovolts so the
+//              integrators wrap exactly instead of drifting; order 1 is a
+//              moving average over `decimation` scans
+//   window     min/max (van Herk/Gil-Werman blocks), mean and standard
+//              deviation over the last `window` CIC outputs, O(1) per output
+//
+// State is stored lane-per-channel in fixed arrays and every stage is a
+// straight loop over the lanes, so the bank never allocates and the
+// compiler can keep all channels in vector registers. The bank runs at the
+// scan rate: a channel without a new conversion in a scan (an ADC2 channel
+// between visits, or a failed read) keeps its last despiked value, and its
+// median only advances on real conversions.
+class AdcFilterBank {
+public:
+    static constexpr int LANES = 4;
+    static constexpr int MAX_MEDIAN = 5;
+    static constexpr int MAX_ORDER = 4;
+    static constexpr int MAX_DECIMATION = 64;
+    static constexpr int MAX_WINDOW = 512;
+
+    struct Config {
+        int median = 3;         // conversions; 1 disables spike rejection
+        int cicOrder = 1;
+        int decimation = 4;     // scans per output
+        int window = 256;       // outputs in the statistics window
+    };
+
+    // One decimated output. Lanes that have not converted yet are NaN.
+    struct Output {
+        double value[LANES];    // despiked and CIC-filtered
+        double min[LANES];
+        double max[LANES];
+        double mean[LANES];
+        double stddev[LANES];
+    };
+
+    AdcFilterBank();
+    explicit AdcFilterBank(const Config& config);
+
+    // Clamps the config to the supported range and resets every lane.
+    void configure(const Config& config);
+    void reset();
+    const Config& config() const { return cfg; }
+
+    // Feeds one scan. Lanes whose `fresh` bit is clear, or whose value is
+    // NaN, hold. Returns true and fills `out` every `decimation` scans.
+    bool push(const double* volts, int count, unsigned fresh, Output& out);
+
+private:
+    Config cfg;
+    int64_t gain = 1;           // decimation^order
+    int warmScans = 0;          // scans before the CIC output is trusted
+
+    unsigned seeded = 0;        // lanes that have converted at least once
+    double median[MAX_MEDIAN][LANES];
+    double despiked[LANES];
+
+    uint64_t integrators[MAX_ORDER][LANES];
+    uint64_t combs[MAX_ORDER][LANES];
+    int warm[LANES];
+    int phase = 0;
+
+    // ring doubles as the current van Herk block; suffix* hold the block
+    // before it, one past the end padded with +-inf.
+    double ring[MAX_WINDOW][LANES];
+    double suffixMin[MAX_WINDOW + 1][LANES];
+    double suffixMax[MAX_WINDOW + 1][LANES];
+    double prefixMin[LANES];
+    double prefixMax[LANES];
+    // Sums are taken about a reference near the lane's level to keep the
+    // variance clear of cancellation. Every wrap rebuilds them from
+    // `pending` and moves the reference to the window mean, so rounding
+    // never accumulates past one window.
+    double reference[LANES];
+    double sum[LANES];
+    double sumSq[LANES];
+    double pendingSum[LANES];
+    double pendingSq[LANES];
+    int pos = 0;
+
+    void seedLane(int lane, double volts);
+};
+
+#endif // ADC_FILTER_BANK_H
@@ -0,0 +1,157 @@
+#include "AdcScanPlan.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int MAX_AVERAGES = 16;
+static constexpr int FIR_MAX_DRATE = 4;     // the FIR filter only runs up to 20 SPS
+
+// Bytes on the wire per visit: the batched read + mux switch, which may
+// carry the channel's MODE0..MODE2, and a plain RDATA1 per extra average.
+static constexpr int SWITCH_FRAME_BYTES = 7 + 6;
+static constexpr int READ_FRAME_BYTES = 7;
+static constexpr int ADC2_SWITCH_FRAME_BYTES = 7 + 4;
+static constexpr double US_PER_BYTE = 8e6 / LinuxSpiDevice::SPEED_HZ;
+
+static const uint8_t FILTERS[] = {
+    Ads1263::FILTER_SINC1, Ads1263::FILTER_SINC2, Ads1263::FILTER_SINC3,
+    Ads1263::FILTER_SINC4, Ads1263::FILTER_FIR
+};
+
+static uint8_t delayCodeFor(int minDelayUs) {
+    for (uint8_t code = 0; code < Ads1263::NUM_DELAYS; ++code)
+        if (Ads1263::delayUs(code) >= minDelayUs)
+            return code;
+    return Ads1263::NUM_DELAYS - 1;
+}
+
+ChannelPlan planChannel(const ChannelSpec& spec) {
+    ChannelPlan best;
+    ChannelPlan quietest;
+    quietest.noiseUv = INFINITY;
+    best.cycleUs = INFINITY;
+
+    uint8_t delay = delayCodeFor(spec.minDelayUs);
+    for (uint8_t drate = 0; drate < Ads1263::NUM_DRATES; ++drate) {
+        double periodUs = 1e6 / Ads1263::dataRateHz(drate);
+        for (uint8_t filter : FILTERS) {
+            if (filter == Ads1263::FILTER_FIR && drate > FIR_MAX_DRATE)
+                continue;
+            double single = Ads1263::noiseUv(drate, filter);
+            for (int n = 1; n <= MAX_AVERAGES; ++n) {
+                ChannelPlan p;
+                p.config.drate = drate;
+                p.config.filter = filter;
+                p.config.delay = delay;
+                p.averages = n;
+                p.noiseUv = single / std::sqrt((double)n);
+                p.cycleUs = Ads1263::delayUs(delay) +
+                            periodUs * (Ads1263::settlingPeriods(filter) + n - 1) +
+                            US_PER_BYTE * (SWITCH_FRAME_BYTES + READ_FRAME_BYTES * (n - 1));
+                p.meetsFloor = p.noiseUv <= spec.noiseUv;
+
+                if (p.meetsFloor && (p.cycleUs < best.cycleUs ||
+                                     (p.cycleUs == best.cycleUs && p.noiseUv < best.noiseUv)))
+                    best = p;
+                if (p.noiseUv < quietest.noiseUv)
+                    quietest = p;
+                // More averages only help once the floor is not yet met.
+                if (p.meetsFloor)
+                    break;
+            }
+        }
+    }
+    return best.meetsFloor ? best : quietest;
+}
+
+ChannelPlan planAdc2Channel(const ChannelSpec& spec) {
+    ChannelPlan best;
+    ChannelPlan quietest;
+    quietest.noiseUv = INFINITY;
+    best.cycleUs = INFINITY;
+
+    // ADC2 has no programmable delay; the mux settles within its sinc3 latency.
+    for (uint8_t drate = 0; drate < Ads1263::NUM_ADC2_DRATES; ++drate) {
+        double periodUs = 1e6 / Ads1263::adc2RateHz(drate);
+        double single = Ads1263::adc2NoiseUv(drate);
+        for (int n = 1; n <= MAX_AVERAGES; ++n) {
+            ChannelPlan p;
+            p.onAdc2 = true;
+            p.config.drate = drate;
+            p.averages = n;
+            p.noiseUv = single / std::sqrt((double)n);
+            p.cycleUs = periodUs * (Ads1263::ADC2_SETTLING_PERIODS + n - 1) +
+                        US_PER_BYTE * (ADC2_SWITCH_FRAME_BYTES + READ_FRAME_BYTES * (n - 1));
+            p.meetsFloor = p.noiseUv <= spec.noiseUv;
+
+            if (p.meetsFloor && p.cycleUs < best.cycleUs)
+                best = p;
+            if (p.noiseUv < quietest.noiseUv)
+                quietest = p;
+            if (p.meetsFloor)
+                break;
+        }
+    }
+    return best.meetsFloor ? best : quietest;
+}
+
+double ScanPlan::channelRate(int channel) const {
+    double roundUs = plans[channel].onAdc2 ? adc2RoundUs : adc1RoundUs;
+    return roundUs > 0 ? 1e6 / roundUs : 0.0;
+}
+
+double ScanPlan::slowestRate() const {
+    double slowest = INFINITY;
+    for (int ch = 0; ch < channels; ++ch)
+        slowest = std::min(slowest, channelRate(ch));
+    return slowest;
+}
+
+ScanPlan planScan(const ChannelSpec* specs, int channels, int adc2Channels) {
+    if (channels > ScanPlan::MAX_CHANNELS)
+        channels = ScanPlan::MAX_CHANNELS;
+    if (adc2Channels > channels - 1)
+        adc2Channels = channels - 1;
+
+    ChannelPlan adc1[ScanPlan::MAX_CHANNELS], adc2[ScanPlan::MAX_CHANNELS];
+    for (int ch = 0; ch < channels; ++ch) {
+        adc1[ch] = planChannel(specs[ch]);
+        adc2[ch] = planAdc2Channel(specs[ch]);
+    }
+
+    // Four channels make at most eight splits; try them all.
+    ScanPlan best;
+    double bestSlowest = -1, bestTotal = -1;
+    for (unsigned mask = 0; mask < (1u << channels); mask += 2) {
+        int onAdc2 = __builtin_popcount(mask);
+        if (adc2Channels >= 0 && mask != (((1u << adc2Channels) - 1) << (channels - adc2Channels)))
+            continue;
+
+        ScanPlan plan;
+        plan.channels = channels;
+        for (int ch = 0; ch < channels; ++ch) {
+            bool second = mask & (1u << ch);
+            plan.plans[ch] = second ? adc2[ch] : adc1[ch];
+            (second ? plan.adc2RoundUs : plan.adc1RoundUs) += plan.plans[ch].cycleUs;
+        }
+        // A lone ADC2 channel never switches its mux, so it converts
+        // continuously instead of settling on every visit.
+        if (onAdc2 == 1) {
+            for (int ch = 0; ch < channels; ++ch) {
+                const ChannelPlan& p = plan.plans[ch];
+                if (p.onAdc2)
+                    plan.adc2RoundUs = p.averages * 1e6 / Ads1263::adc2RateHz(p.config.drate);
+            }
+        }
+
+        double slowest = plan.slowestRate();
+        double total = 0;
+        for (int ch = 0; ch < channels; ++ch)
+            total += plan.channelRate(ch);
+        if (slowest > bestSlowest || (slowest == bestSlowest && total > bestTotal)) {
+            best = plan;
+            bestSlowest = slowest;
+            bestTotal = total;
+        }
+    }
+    return best;
+}
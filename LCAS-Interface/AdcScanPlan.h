@@ -0,0 +1,52 @@
+#ifndef ADC_SCAN_PLAN_H
+#define ADC_SCAN_PLAN_H
+
+#include "Ads1263.h"
+
+// What a channel needs from the converter.
+struct ChannelSpec {
+    double noiseUv = 5.0;       // required RMS noise floor
+    int minDelayUs = 35;        // front-end settling after a mux switch
+};
+
+// How a channel is converted on each visit of the scan: `averages`
+// back-to-back conversions at `config` after the mux switch. On ADC2 only
+// config.drate is used, as an ADC2 rate code.
+struct ChannelPlan {
+    Ads1263::Config config;
+    bool onAdc2 = false;
+    int averages = 1;
+    double noiseUv = 0.0;       // expected after averaging
+    double cycleUs = 0.0;       // mux switch to the last read, SPI included
+    bool meetsFloor = false;    // false if even the quietest setting misses it
+};
+
+// Chooses data rate, filter, settling delay and averaging to minimize a
+// channel's visit time subject to its noise floor. Visits are independent,
+// so per-channel minima also minimize the whole scan. Falls back to the
+// quietest setting when the floor is out of reach.
+ChannelPlan planChannel(const ChannelSpec& spec);
+ChannelPlan planAdc2Channel(const ChannelSpec& spec);
+
+// Both converters run at once on disjoint channel sets: ADC1 paced by DRDY,
+// ADC2 serviced whenever its flag shows up in an ADC1 read. A channel's
+// rate is one over its converter's round (the sum of that converter's
+// visits).
+struct ScanPlan {
+    static constexpr int MAX_CHANNELS = 4;
+
+    int channels = 0;
+    ChannelPlan plans[MAX_CHANNELS];
+    double adc1RoundUs = 0.0;
+    double adc2RoundUs = 0.0;
+
+    double channelRate(int channel) const;
+    double slowestRate() const;
+};
+
+// Splits the channels between the converters to maximize the slowest
+// channel's rate, then the aggregate; ADC1 always keeps channel 0.
+// adc2Channels >= 0 forces that many of the highest channels onto ADC2.
+ScanPlan planScan(const ChannelSpec* specs, int channels, int adc2Channels = -1);
+
+#endif // ADC_SCAN_PLAN_H
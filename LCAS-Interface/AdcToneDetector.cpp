@@ -0,0 +1,125 @@
+#include "AdcToneDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double NAN_VALUE = std::numeric_limits<double>::quiet_NaN();
+static constexpr int MAX_GAP_PERIODS = 10;  // longer gaps restart the block
+
+AdcToneDetector::AdcToneDetector() {
+    configure(Config());
+}
+
+AdcToneDetector::AdcToneDetector(const Config& config) {
+    configure(config);
+}
+
+void AdcToneDetector::configure(const Config& config) {
+    cfg = config;
+    cfg.tones = std::clamp(cfg.tones, 0, MAX_TONES);
+    if (!(cfg.bandwidthHz > 0))
+        cfg.bandwidthHz = Config().bandwidthHz;
+    reset();
+}
+
+void AdcToneDetector::reset() {
+    for (Lane& lane : lanes)
+        lane = Lane();
+}
+
+void AdcToneDetector::restartBlocks() {
+    for (Lane& lane : lanes)
+        if (lane.calibrated)
+            startBlock(lane);
+}
+
+void AdcToneDetector::startBlock(Lane& lane) {
+    lane.n = 0;
+    lane.sum = 0.0;
+    lane.winCos = 1.0;
+    lane.winSin = 0.0;
+    for (int t = 0; t < MAX_TONES; ++t)
+        lane.s1[t] = lane.s2[t] = 0.0;
+}
+
+bool AdcToneDetector::push(const double* volts, const int64_t* timeUs, int count, unsigned fresh,
+                           Output& out) {
+    if (!enabled())
+        return false;
+
+    out.updated = 0;
+    const int tones = cfg.tones;
+    for (int ch = 0; ch < count && ch < LANES; ++ch) {
+        double v = volts[ch];
+        if (!(fresh >> ch & 1u) || std::isnan(v))
+            continue;
+        Lane& lane = lanes[ch];
+        int64_t t = timeUs[ch];
+
+        if (lane.n > 0 && lane.calibrated &&
+            (t - lane.lastUs) * 1e-6 * lane.rateHz > MAX_GAP_PERIODS)
+            startBlock(lane);
+        if (lane.n == 0) {
+            lane.firstUs = t;
+            if (!lane.calibrated)
+                lane.mean = v;
+        }
+        lane.lastUs = t;
+        lane.sum += v;
+
+        // Periodic Hann weight 0.5 - 0.5 cos(2 pi n / N), by rotation.
+        double x = (v - lane.mean) * (0.5 - 0.5 * lane.winCos);
+        double c = lane.winCos * lane.stepCos - lane.winSin * lane.stepSin;
+        lane.winSin = lane.winSin * lane.stepCos + lane.winCos * lane.stepSin;
+        lane.winCos = c;
+
+        for (int k = 0; k < tones; ++k) {
+            double s0 = x + lane.coeff[k] * lane.s1[k] - lane.s2[k];
+            lane.s2[k] = lane.s1[k];
+            lane.s1[k] = s0;
+        }
+        if (++lane.n == lane.length)
+            finishBlock(ch, out);
+    }
+    return out.updated != 0;
+}
+
+void AdcToneDetector::finishBlock(int ch, Output& out) {
+    Lane& lane = lanes[ch];
+    const int tones = cfg.tones;
+
+    if (lane.calibrated) {
+        // |X|^2 from the last two Goertzel states; the Hann window's
+        // coherent gain is N/2, and a sine of peak A has |X| = A N / 4.
+        for (int k = 0; k < tones; ++k) {
+            double power = lane.s1[k] * lane.s1[k] + lane.s2[k] * lane.s2[k] -
+                           lane.coeff[k] * lane.s1[k] * lane.s2[k];
+            double peak = 4.0 * std::sqrt(std::max(0.0, power)) / lane.length;
+            out.rms[ch][k] = std::isnan(lane.coeff[k]) ? NAN_VALUE : peak / std::sqrt(2.0);
+        }
+        out.blockHz[ch] = lane.rateHz;
+        out.updated |= 1u << ch;
+    } else {
+        for (int k = 0; k < MAX_TONES; ++k)
+            out.rms[ch][k] = NAN_VALUE;
+        out.blockHz[ch] = NAN_VALUE;
+    }
+
+    // Re-plan the next block from this one's measured rate and level.
+    double spanS = (lane.lastUs - lane.firstUs) * 1e-6;
+    if (spanS > 0)
+        lane.rateHz = (lane.n - 1) / spanS;
+    lane.mean = lane.sum / lane.n;
+    if (lane.rateHz > 0) {
+        lane.calibrated = true;
+        lane.length = std::clamp((int)std::lround(lane.rateHz / cfg.bandwidthHz), MIN_BLOCK, MAX_BLOCK);
+        double step = 2.0 * M_PI / lane.length;
+        lane.stepCos = std::cos(step);
+        lane.stepSin = std::sin(step);
+        for (int k = 0; k < tones; ++k) {
+            double w = 2.0 * M_PI * cfg.toneHz[k] / lane.rateHz;
+            lane.coeff[k] = cfg.toneHz[k] > 0 && cfg.toneHz[k] < lane.rateHz / 2 ? 2.0 * std::cos(w) : NAN_VALUE;
+        }
+    }
+    startBlock(lane);
+}
@@ -0,0 +1,85 @@
+#ifndef ADC_TONE_DETECTOR_H
+#define ADC_TONE_DETECTOR_H
+
+#include <cstdint>
+
+// Narrow-band detector for the modulated laser on the stray-light channels.
+// The ambient level is DC or slowly varying, so a DC threshold has to sit
+// above it; the laser's modulation shows up as power at known frequencies
+// instead. Each channel runs one Goertzel filter per configured tone over
+// blocks of samples and reports the tone's RMS amplitude at the end of
+// every block.
+//
+// Blocks are Hann-windowed (the weight comes from a rotating phasor, so
+// there is no table) and have the previous block's mean removed, which
+// keeps the ambient level and its drift out of the tone bins. The block
+// length is the channel's sample rate over the configured bandwidth. The
+// rate is measured from the conversion timestamps: a first calibration
+// block only measures, and every block re-measures for the next one, so
+// channels on ADC2 or with a changed scan plan need no configuration.
+//
+// Memory is fixed: a few doubles per channel and tone, no buffers.
+class AdcToneDetector {
+public:
+    static constexpr int LANES = 4;
+    static constexpr int MAX_TONES = 4;
+    static constexpr int MIN_BLOCK = 16;
+    static constexpr int MAX_BLOCK = 8192;
+    static constexpr int CALIBRATION_SAMPLES = 32;
+
+    struct Config {
+        double toneHz[MAX_TONES] = {};
+        int tones = 0;              // 0 disables the detector
+        double bandwidthHz = 5.0;   // bin width; sets the block length
+    };
+
+    struct Output {
+        // RMS volts at each tone; NaN until a channel's first block, or when
+        // the tone is above the channel's Nyquist frequency.
+        double rms[LANES][MAX_TONES] = {};
+        double blockHz[LANES] = {};     // measured sample rate
+        unsigned updated = 0;       // channels that finished a block this push
+    };
+
+    AdcToneDetector();
+    explicit AdcToneDetector(const Config& config);
+
+    void configure(const Config& config);
+    void reset();
+    void restartBlocks();   // after lost samples; keeps the calibration
+    const Config& config() const { return cfg; }
+    bool enabled() const { return cfg.tones > 0; }
+
+    // Feeds one sample per channel whose `fresh` bit is set and whose value
+    // is not NaN, taken at timeUs[channel]. Returns true when at least one
+    // channel finished a block, with the finished channels flagged in
+    // out.updated; the other channels' entries are left as they were.
+    bool push(const double* volts, const int64_t* timeUs, int count, unsigned fresh, Output& out);
+
+private:
+    struct Lane {
+        bool calibrated = false;
+        int length = CALIBRATION_SAMPLES;
+        int n = 0;
+        int64_t firstUs = 0;
+        int64_t lastUs = 0;
+        double rateHz = 0.0;
+        double mean = 0.0;
+        double sum = 0.0;
+        double winCos = 1.0;    // Hann phasor
+        double winSin = 0.0;
+        double stepCos = 1.0;
+        double stepSin = 0.0;
+        double coeff[MAX_TONES] = {};   // 2 cos(w); NaN above Nyquist
+        double s1[MAX_TONES] = {};
+        double s2[MAX_TONES] = {};
+    };
+
+    Config cfg;
+    Lane lanes[LANES];
+
+    void startBlock(Lane& lane);
+    void finishBlock(int channel, Output& out);
+};
+
+#endif // ADC_TONE_DETECTOR_H
@@ -0,0 +1,280 @@
+#include "Ads1263.h"
+#include <cmath>
+#include <cstdio>
+
+static const double DRATE_HZ[Ads1263::NUM_DRATES] = {
+    2.5, 5, 10, 16.6, 20, 50, 60, 100, 400, 1200, 2400, 4800, 7200, 14400, 19200, 38400
+};
+
+static const int DELAY_US[Ads1263::NUM_DELAYS] = {
+    0, 9, 17, 35, 69, 139, 278, 555, 1100, 2200, 4400, 8800
+};
+
+static const double ADC2_DRATE_HZ[Ads1263::NUM_ADC2_DRATES] = {10, 100, 400, 800};
+
+Ads1263::Ads1263(SpiDevice& spi) : spi(spi) {}
+
+bool Ads1263::init(const Config& config) {
+    spi.reset();
+
+    int id = readReg(REG_ID);
+    if (id < 0 || (id >> 5) != 0x01) {
+        fprintf(stderr, "ADS1263: bad chip ID 0x%02x\n", id < 0 ? 0 : id);
+        return false;
+    }
+
+    command(CMD_STOP1);
+    if (!configureAdc1(config))
+        return false;
+    return command(CMD_START1);
+}
+
+bool Ads1263::configureAdc1(const Config& config) {
+    // PGA bypassed, gain 1; VDD/VSS as reference.
+    bool ok = writeReg(REG_MODE2, 0x80 | (config.drate & 0x0F)) &&
+              writeReg(REG_REFMUX, 0x24) &&
+              writeReg(REG_MODE0, config.delay & 0x0F) &&
+              writeReg(REG_MODE1, config.filter);
+    if (ok)
+        current = config;
+    return ok;
+}
+
+bool Ads1263::command(uint8_t cmd) {
+    SpiTransfer xfer;
+    xfer.tx = &cmd;
+    xfer.len = 1;
+    return spi.transfer(&xfer, 1) == 0;
+}
+
+bool Ads1263::writeReg(uint8_t reg, uint8_t value, bool verify) {
+    const uint8_t tx[3] = {(uint8_t)(CMD_WREG | reg), 0x00, value};
+    SpiTransfer xfer;
+    xfer.tx = tx;
+    xfer.len = sizeof(tx);
+    if (spi.transfer(&xfer, 1) != 0)
+        return false;
+    if (verify && readReg(reg) != value) {
+        fprintf(stderr, "ADS1263: register 0x%02x did not read back 0x%02x\n", reg, value);
+        return false;
+    }
+    return true;
+}
+
+int Ads1263::readReg(uint8_t reg) {
+    uint8_t tx[3] = {(uint8_t)(CMD_RREG | reg), 0x00, 0x00};
+    uint8_t rx[3] = {};
+    SpiTransfer xfer;
+    xfer.tx = tx;
+    xfer.rx = rx;
+    xfer.len = sizeof(tx);
+    if (spi.transfer(&xfer, 1) != 0)
+        return -1;
+    return rx[2];
+}
+
+uint8_t Ads1263::diffMux(int channel) {
+    return (uint8_t)(((2 * channel) << 4) | (2 * channel + 1));
+}
+
+bool Ads1263::selectDiffChannel(int channel) {
+    if (channel < 0 || channel >= DIFF_CHANNELS)
+        return false;
+    // No read-back on the scan path; init() has already proven the link.
+    if (!writeReg(REG_INPMUX, diffMux(channel), false))
+        return false;
+    spi.clearDataReady();
+    return true;
+}
+
+bool Ads1263::selectDiffChannel(int channel, const Config& config) {
+    if (channel < 0 || channel >= DIFF_CHANNELS)
+        return false;
+    uint8_t tx[6];
+    SpiTransfer xfer;
+    xfer.tx = tx;
+    xfer.len = switchCommand(tx, channel, config);
+    if (spi.transfer(&xfer, 1) != 0)
+        return false;
+    current = config;
+    spi.clearDataReady();
+    return true;
+}
+
+int Ads1263::switchCommand(uint8_t* buf, int channel, const Config& config) const {
+    if (config.drate == current.drate && config.filter == current.filter &&
+        config.delay == current.delay) {
+        buf[0] = CMD_WREG | REG_INPMUX;
+        buf[1] = 0x00;
+        buf[2] = diffMux(channel);
+        return 3;
+    }
+    // MODE0, MODE1, MODE2 and INPMUX are adjacent: one WREG covers them.
+    buf[0] = CMD_WREG | REG_MODE0;
+    buf[1] = 0x03;
+    buf[2] = config.delay & 0x0F;
+    buf[3] = config.filter;
+    buf[4] = 0x80 | (config.drate & 0x0F);
+    buf[5] = diffMux(channel);
+    return 6;
+}
+
+int Ads1263::parseAdc1(const uint8_t* rx, int32_t& code) {
+    // rx[0] answers the opcode; then status, four data bytes, checksum.
+    status = rx[1];
+    if (!(rx[1] & STATUS_ADC1_NEW))
+        return 0;
+    if (checksum(rx + 2, 4) != rx[6]) {
+        ++badChecksums;
+        return -1;
+    }
+    code = (int32_t)((uint32_t)rx[2] << 24 | (uint32_t)rx[3] << 16 | (uint32_t)rx[4] << 8 | rx[5]);
+    return 1;
+}
+
+int Ads1263::readAdc1(int32_t& code) {
+    uint8_t tx[7] = {CMD_RDATA1};
+    uint8_t rx[7] = {};
+    SpiTransfer xfer;
+    xfer.tx = tx;
+    xfer.rx = rx;
+    xfer.len = sizeof(tx);
+    if (spi.transfer(&xfer, 1) != 0)
+        return -1;
+    return parseAdc1(rx, code);
+}
+
+int Ads1263::readAdc1AndSelect(int32_t& code, int nextChannel, const Config& nextConfig) {
+    if (nextChannel < 0 || nextChannel >= DIFF_CHANNELS)
+        return -1;
+
+    // The read comes first: the switch restarts the conversion.
+    uint8_t readTx[7] = {CMD_RDATA1};
+    uint8_t readRx[7] = {};
+    uint8_t switchTx[6];
+    SpiTransfer xfers[2];
+    xfers[0].tx = readTx;
+    xfers[0].rx = readRx;
+    xfers[0].len = sizeof(readTx);
+    xfers[1].tx = switchTx;
+    xfers[1].len = switchCommand(switchTx, nextChannel, nextConfig);
+    if (spi.transfer(xfers, 2) != 0)
+        return -1;
+    current = nextConfig;
+    spi.clearDataReady();
+    return parseAdc1(readRx, code);
+}
+
+void Ads1263::adc2SwitchCommand(uint8_t* buf, int channel, uint8_t drate) {
+    // VAVDD/VAVSS reference, gain 1.
+    buf[0] = CMD_WREG | REG_ADC2CFG;
+    buf[1] = 0x01;
+    buf[2] = 0x20 | (uint8_t)((drate & 0x03) << 6);
+    buf[3] = diffMux(channel);
+}
+
+bool Ads1263::selectAdc2DiffChannel(int channel, uint8_t drate) {
+    if (channel < 0 || channel >= DIFF_CHANNELS)
+        return false;
+    uint8_t tx[4];
+    adc2SwitchCommand(tx, channel, drate);
+    SpiTransfer xfer;
+    xfer.tx = tx;
+    xfer.len = sizeof(tx);
+    return spi.transfer(&xfer, 1) == 0;
+}
+
+int Ads1263::parseAdc2(const uint8_t* rx, int32_t& code) {
+    // Opcode, status, three data bytes, a pad byte, then the checksum.
+    status = rx[1];
+    if (!(rx[1] & STATUS_ADC2_NEW))
+        return 0;
+    if (checksum(rx + 2, 3) != rx[6]) {
+        ++badChecksums;
+        return -1;
+    }
+    code = (int32_t)((uint32_t)rx[2] << 24 | (uint32_t)rx[3] << 16 | (uint32_t)rx[4] << 8);
+    return 1;
+}
+
+int Ads1263::transferAdc2(int32_t& code, int nextChannel, uint8_t nextDrate) {
+    uint8_t readTx[7] = {CMD_RDATA2};
+    uint8_t readRx[7] = {};
+    uint8_t switchTx[4];
+    SpiTransfer xfers[2];
+    xfers[0].tx = readTx;
+    xfers[0].rx = readRx;
+    xfers[0].len = sizeof(readTx);
+    int count = 1;
+    if (nextChannel >= 0) {
+        adc2SwitchCommand(switchTx, nextChannel, nextDrate);
+        xfers[1].tx = switchTx;
+        xfers[1].len = sizeof(switchTx);
+        count = 2;
+    }
+    if (spi.transfer(xfers, count) != 0)
+        return -1;
+    return parseAdc2(readRx, code);
+}
+
+int Ads1263::readAdc2(int32_t& code) {
+    return transferAdc2(code, -1, 0);
+}
+
+int Ads1263::readAdc2AndSelect(int32_t& code, int nextChannel, uint8_t nextDrate) {
+    if (nextChannel < 0 || nextChannel >= DIFF_CHANNELS)
+        return -1;
+    return transferAdc2(code, nextChannel, nextDrate);
+}
+
+uint8_t Ads1263::checksum(const uint8_t* data, int len) {
+    unsigned sum = CHECKSUM_SEED;
+    for (int i = 0; i < len; ++i)
+        sum += data[i];
+    return (uint8_t)sum;
+}
+
+double Ads1263::codeToVolts(int32_t code) {
+    if (code < 0)
+        return -(double)code * REF_VOLTS / 2147483648.0;
+    return (double)code * REF_VOLTS / 2147483647.0;
+}
+
+double Ads1263::dataRateHz(uint8_t drate) {
+    return DRATE_HZ[drate & 0x0F];
+}
+
+int Ads1263::delayUs(uint8_t delay) {
+    delay &= 0x0F;
+    return delay < NUM_DELAYS ? DELAY_US[delay] : DELAY_US[NUM_DELAYS - 1];
+}
+
+int Ads1263::settlingPeriods(uint8_t filter) {
+    switch (filter) {
+    case FILTER_SINC2: return 2;
+    case FILTER_SINC3: return 3;
+    case FILTER_SINC4: return 4;
+    default: return 1;     // sinc1, and FIR which settles in one output
+    }
+}
+
+double Ads1263::noiseUv(uint8_t drate, uint8_t filter) {
+    // About 0.9 uV RMS for sinc1 at 100 SPS, growing with sqrt(rate).
+    double sinc1 = 0.09 * std::sqrt(dataRateHz(drate));
+    switch (filter) {
+    case FILTER_SINC2: return sinc1 * 0.85;
+    case FILTER_SINC3: return sinc1 * 0.75;
+    case FILTER_SINC4: return sinc1 * 0.70;
+    case FILTER_FIR: return sinc1 * 0.70;
+    default: return sinc1;
+    }
+}
+
+double Ads1263::adc2RateHz(uint8_t drate) {
+    return ADC2_DRATE_HZ[drate & 0x03];
+}
+
+double Ads1263::adc2NoiseUv(uint8_t drate) {
+    // The auxiliary converter is several times noisier than ADC1.
+    return 0.45 * std::sqrt(adc2RateHz(drate));
+}
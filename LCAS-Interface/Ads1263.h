@@ -0,0 +1,136 @@
+#ifndef ADS1263_H
+#define ADS1263_H
+
+#include <cstdint>
+#include "SpiDevice.h"
+
+// ADS1263 register and command level driver, ported from the Waveshare
+// ADS1263.py that the stray-light path used to run. All I/O goes through a
+// SpiDevice; a register write or a data read is one chip-select frame
+// rather than one transfer per byte.
+class Ads1263 {
+public:
+    // Registers
+    static constexpr uint8_t REG_ID = 0x00;
+    static constexpr uint8_t REG_POWER = 0x01;
+    static constexpr uint8_t REG_INTERFACE = 0x02;
+    static constexpr uint8_t REG_MODE0 = 0x03;
+    static constexpr uint8_t REG_MODE1 = 0x04;
+    static constexpr uint8_t REG_MODE2 = 0x05;
+    static constexpr uint8_t REG_INPMUX = 0x06;
+    static constexpr uint8_t REG_REFMUX = 0x0F;
+    static constexpr uint8_t REG_ADC2CFG = 0x15;
+    static constexpr uint8_t REG_ADC2MUX = 0x16;
+    static constexpr int NUM_REGS = 0x1B;
+
+    // Commands
+    static constexpr uint8_t CMD_RESET = 0x06;
+    static constexpr uint8_t CMD_START1 = 0x08;
+    static constexpr uint8_t CMD_STOP1 = 0x0A;
+    static constexpr uint8_t CMD_START2 = 0x0C;
+    static constexpr uint8_t CMD_STOP2 = 0x0E;
+    static constexpr uint8_t CMD_RDATA1 = 0x12;
+    static constexpr uint8_t CMD_RDATA2 = 0x14;
+    static constexpr uint8_t CMD_RREG = 0x20;
+    static constexpr uint8_t CMD_WREG = 0x40;
+
+    // MODE1 digital filter
+    static constexpr uint8_t FILTER_SINC1 = 0x04;
+    static constexpr uint8_t FILTER_SINC2 = 0x24;
+    static constexpr uint8_t FILTER_SINC3 = 0x44;
+    static constexpr uint8_t FILTER_SINC4 = 0x64;
+    static constexpr uint8_t FILTER_FIR = 0x84;
+
+    // MODE2 data rate codes, 2.5 SPS (0) to 38400 SPS (15)
+    static constexpr uint8_t DRATE_50SPS = 0x05;
+    static constexpr int NUM_DRATES = 16;
+    // MODE0 conversion delay codes, 0 (none) to 11 (8.8 ms)
+    static constexpr uint8_t DELAY_35US = 0x03;
+    static constexpr int NUM_DELAYS = 12;
+    // ADC2CFG data rate codes, 10 (0), 100, 400, 800 SPS (3); sinc3 only
+    static constexpr uint8_t ADC2_DRATE_100SPS = 0x01;
+    static constexpr int NUM_ADC2_DRATES = 4;
+    static constexpr int ADC2_SETTLING_PERIODS = 3;
+
+    static constexpr uint8_t STATUS_ADC1_NEW = 0x40;
+    static constexpr uint8_t STATUS_ADC2_NEW = 0x80;
+    static constexpr uint8_t CHECKSUM_SEED = 0x9B;
+    static constexpr int DIFF_CHANNELS = 5;     // AIN0-1 .. AIN8-9
+    static constexpr double REF_VOLTS = 5.08;
+
+    struct Config {
+        uint8_t drate = DRATE_50SPS;
+        uint8_t filter = FILTER_FIR;
+        uint8_t delay = DELAY_35US;
+    };
+
+    explicit Ads1263(SpiDevice& spi);
+
+    // Reset, chip ID check, ADC1 configuration and START1. False if the
+    // chip does not answer or a register does not read back.
+    bool init(const Config& config);
+    bool init() { return init(Config()); }
+    bool configureAdc1(const Config& config);
+
+    bool command(uint8_t cmd);
+    bool writeReg(uint8_t reg, uint8_t value, bool verify = true);
+    int readReg(uint8_t reg);   // -1 on error
+
+    // AINp = 2n, AINn = 2n+1. Restarts the ADC1 conversion.
+    bool selectDiffChannel(int channel);
+    // The same with a per-channel configuration; MODE0..MODE2 are only
+    // rewritten when they differ from what the chip holds.
+    bool selectDiffChannel(int channel, const Config& config);
+    static uint8_t diffMux(int channel);
+
+    // RDATA1 with status and checksum. Returns 1 with a new conversion in
+    // code, 0 if the chip had no new data, -1 on I/O or checksum error.
+    int readAdc1(int32_t& code);
+    // RDATA1 for the current channel and the switch to the next one in a
+    // single chip-select frame (one SPI_IOC_MESSAGE). Returns as readAdc1;
+    // the switch happens even if the read fails.
+    int readAdc1AndSelect(int32_t& code, int nextChannel, const Config& nextConfig);
+
+    // ADC2 converts alongside ADC1 with its own mux. It has no DRDY pin;
+    // its new-data flag rides in the status byte of every RDATA1/RDATA2.
+    // ADC2CFG and ADC2MUX are adjacent, so rate and channel are set by
+    // one WREG. Restarts the ADC2 conversion.
+    bool selectAdc2DiffChannel(int channel, uint8_t drate);
+    // RDATA2, and with a channel the switch in the same frame. 24-bit
+    // results come back scaled to 32 bits, so codeToVolts applies.
+    int readAdc2(int32_t& code);
+    int readAdc2AndSelect(int32_t& code, int nextChannel, uint8_t nextDrate);
+    bool adc2Ready() const { return (status & STATUS_ADC2_NEW) != 0; }
+
+    const Config& config() const { return current; }
+    uint64_t checksumErrors() const { return badChecksums; }
+
+    static uint8_t checksum(const uint8_t* data, int len);
+    // Magnitude of the differential input against REF_VOLTS, as
+    // readadcsimple.py reported it, so existing thresholds keep their meaning.
+    static double codeToVolts(int32_t code);
+    static double dataRateHz(uint8_t drate);
+    static int delayUs(uint8_t delay);
+    // Conversion periods from a restart to the first settled result.
+    static int settlingPeriods(uint8_t filter);
+    // Typical input-referred RMS noise at gain 1. Approximates the
+    // datasheet tables as sqrt(rate) growth, less for the higher-order filters.
+    static double noiseUv(uint8_t drate, uint8_t filter);
+    static double adc2RateHz(uint8_t drate);
+    static double adc2NoiseUv(uint8_t drate);
+
+private:
+    SpiDevice& spi;
+    Config current;
+    uint8_t status = 0;         // from the last data read
+    uint64_t badChecksums = 0;
+
+    // Fills buf with a WREG for the channel switch; returns its length.
+    int switchCommand(uint8_t* buf, int channel, const Config& config) const;
+    int parseAdc1(const uint8_t* rx, int32_t& code);
+    int parseAdc2(const uint8_t* rx, int32_t& code);
+    int transferAdc2(int32_t& code, int nextChannel, uint8_t nextDrate);
+    static void adc2SwitchCommand(uint8_t* buf, int channel, uint8_t drate);
+};
+
+#endif // ADS1263_H
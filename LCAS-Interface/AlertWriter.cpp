@@ -0,0 +1,95 @@
+#include "AlertWriter.h"
+#include "ThermalCameraManager.h"
+#include "Metrics.h"
+#include <sys/stat.h>
+#include <cstdio>
+#include <ctime>
+
+AlertWriter::AlertWriter(const std::string& directory, size_t capacity, DropPolicy policy)
+    : directory(directory), policy(policy), ring(capacity > 0 ? capacity : 1) {
+    worker = std::thread(&AlertWriter::run, this);
+}
+
+AlertWriter::~AlertWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool AlertWriter::submit(Job&& job) {
+    bool accepted = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == ring.size()) {
+            dropped.fetch_add(1);
+            metrics.count(Metrics::Counter::AlertsDropped);
+            if (policy == DropPolicy::DropNewest)
+                return false;
+            head = (head + 1) % ring.size();
+            --count;
+            accepted = false;
+        }
+        ring[(head + count) % ring.size()] = std::move(job);
+        ++count;
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+    return accepted;
+}
+
+void AlertWriter::run() {
+    mkdir(directory.c_str(), 0755);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || count > 0; });
+        if (count == 0)
+            return;
+
+        Job job = std::move(ring[head]);
+        head = (head + 1) % ring.size();
+        --count;
+
+        lock.unlock();
+        write(job);
+        lock.lock();
+    }
+}
+
+void AlertWriter::write(const Job& job) {
+    using namespace std::chrono;
+    const ThermalFrame& frame = *job.frame;
+    time_t secs = system_clock::to_time_t(job.time);
+    int millis = (int)(duration_cast<milliseconds>(job.time.time_since_epoch()).count() % 1000);
+    struct tm t;
+    localtime_r(&secs, &t);
+
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/cam%d_%04d%02d%02d_%02d%02d%02d_%03d_x%dy%d_n%d.jpg",
+             directory.c_str(), frame.camIndex, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+             t.tm_hour, t.tm_min, t.tm_sec, millis,
+             frame.stats.maxX, frame.stats.maxY, frame.stats.overThreshold);
+
+    // cv::imwrite throws on encoder errors, and an exception escaping this
+    // thread would take the process and its interlocks down with it.
+    try {
+        cv::Mat image = ThermalCameraManager::colorize(frame.pixels);
+        bool ok = cv::imwrite(filename, image);
+        if (!ok) {
+            // The directory may have gone away (card remounted, cleaned up).
+            mkdir(directory.c_str(), 0755);
+            ok = cv::imwrite(filename, image);
+        }
+        if (ok) {
+            written.fetch_add(1);
+            return;
+        }
+        fprintf(stderr, "Alert writer: cannot write %s\n", filename);
+    } catch (const cv::Exception& e) {
+        fprintf(stderr, "Alert writer: %s: %s\n", filename, e.what());
+    }
+    failed.fetch_add(1);
+}
@@ -0,0 +1,67 @@
+#ifndef ALERT_WRITER_H
+#define ALERT_WRITER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ThermalFrame.h"
+
+// Writes alert JPEGs on a background thread so the acquisition thread never
+// waits on mkdir, colorizing, JPEG encoding or the SD card. Jobs go into a fixed-size
+// ring; when it is full the drop policy decides which frame is lost.
+class AlertWriter {
+public:
+    enum class DropPolicy {
+        DropNewest,   // keep what is already queued (preserves the trip onset)
+        DropOldest    // evict the oldest queued job to make room
+    };
+
+    struct Job {
+        ThermalFramePtr frame;
+        std::chrono::system_clock::time_point time;
+    };
+
+    explicit AlertWriter(const std::string& directory = "thermal_alerts",
+                         size_t capacity = 8, DropPolicy policy = DropPolicy::DropNewest);
+    ~AlertWriter();   // writes what is queued, then joins
+
+    AlertWriter(const AlertWriter&) = delete;
+    AlertWriter& operator=(const AlertWriter&) = delete;
+
+    // Never blocks. Returns false if a frame was dropped to honour the policy.
+    bool submit(Job&& job);
+
+    uint64_t queuedCount() const { return queued.load(); }
+    uint64_t writtenCount() const { return written.load(); }
+    uint64_t droppedCount() const { return dropped.load(); }
+    uint64_t failedCount() const { return failed.load(); }
+
+private:
+    std::string directory;
+    DropPolicy policy;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> ring;
+    size_t head = 0;    // index of the oldest job
+    size_t count = 0;
+    bool stopping = false;
+
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> failed{0};
+
+    std::thread worker;
+
+    void run();
+    void write(const Job& job);
+};
+
+#endif // ALERT_WRITER_H
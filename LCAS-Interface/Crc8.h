@@ -0,0 +1,62 @@
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-8 with polynomial 0x07, MSB first, no reflection or final XOR: the
+// SMBus PEC used by the D6T. Header-only so the GUI and the ThermalCameras/
+// tools share one implementation.
+//
+// crc8_update processes eight bytes per step with slice-by-8 tables: table k
+// holds the CRC of a byte followed by k zero bytes, so the contributions of
+// eight input bytes are independent lookups XORed together. Results are
+// identical to the bit-at-a-time loop kept as crc8_bitwise.
+
+struct Crc8Tables {
+    uint8_t t[8][256];
+};
+
+constexpr uint8_t crc8_shift8(uint8_t data) {
+    for (int i = 0; i < 8; ++i)
+        data = (data & 0x80) ? (uint8_t)((data << 1) ^ 0x07) : (uint8_t)(data << 1);
+    return data;
+}
+
+constexpr Crc8Tables crc8_makeTables() {
+    Crc8Tables tables = {};
+    for (int i = 0; i < 256; ++i)
+        tables.t[0][i] = crc8_shift8((uint8_t)i);
+    for (int k = 1; k < 8; ++k)
+        for (int i = 0; i < 256; ++i)
+            tables.t[k][i] = tables.t[0][tables.t[k - 1][i]];
+    return tables;
+}
+
+inline constexpr Crc8Tables CRC8_TABLES = crc8_makeTables();
+
+inline uint8_t crc8_byte(uint8_t crc, uint8_t data) {
+    return CRC8_TABLES.t[0][crc ^ data];
+}
+
+inline uint8_t crc8_update(uint8_t crc, const uint8_t* buf, size_t n) {
+    const auto& t = CRC8_TABLES.t;
+    while (n >= 8) {
+        crc = t[7][crc ^ buf[0]] ^ t[6][buf[1]] ^ t[5][buf[2]] ^ t[4][buf[3]] ^
+              t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]];
+        buf += 8;
+        n -= 8;
+    }
+    while (n--)
+        crc = t[0][crc ^ *buf++];
+    return crc;
+}
+
+// Reference implementation, one bit per iteration.
+inline uint8_t crc8_bitwise(uint8_t crc, const uint8_t* buf, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        crc = crc8_shift8(crc ^ buf[i]);
+    return crc;
+}
+
+#endif // CRC8_H
@@ -0,0 +1,30 @@
+#ifndef D6T_PROTOCOL_H
+#define D6T_PROTOCOL_H
+
+#include <cstdint>
+#include <cstdio>
+#include "Crc8.h"
+
+// Frame-level helpers for the Omron D6T-32L read (0x4D): a little-endian
+// PTAT word, N_PIXEL little-endian pixel words in 0.1 degC, then one SMBus
+// PEC byte computed over the read address and the payload.
+
+inline uint8_t D6T_calcPEC(uint8_t addr, const uint8_t buf[], int n) {
+    return crc8_update(crc8_byte(0, (addr << 1) | 1), buf, n);
+}
+
+// Returns true when the PEC byte at buf[n] does not match.
+inline bool D6T_checkPEC(uint8_t addr, const uint8_t buf[], int n) {
+    uint8_t crc = D6T_calcPEC(addr, buf, n);
+    if (crc != buf[n]) {
+        fprintf(stderr, "PEC check failed: %02X != %02X\n", crc, buf[n]);
+        return true;
+    }
+    return false;
+}
+
+inline int16_t conv8us_s16_le(const uint8_t* buf, int n) {
+    return (int16_t)((buf[n + 1] << 8) | buf[n]);
+}
+
+#endif // D6T_PROTOCOL_H
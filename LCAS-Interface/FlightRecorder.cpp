@@ -0,0 +1,247 @@
+#include "FlightRecorder.h"
+#include "ThermalCameraManager.h"
+#include "D6TProtocol.h"
+#include <sys/stat.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+FlightRecorder::FlightRecorder(double seconds, int frameRateHz, int adcRateHz, const std::string& directory)
+    : directory(directory), seconds(seconds) {
+    size_t frameRecords = (size_t)(seconds * frameRateHz) + 1;
+    size_t adcSlots = (size_t)(seconds * adcRateHz) + 1;
+    for (auto& ring : frames) {
+        ring.records.resize(frameRecords);
+        ring.pixels.resize(frameRecords * ThermalCameraManager::N_PIXEL);
+    }
+    adc.resize(adcSlots);
+    worker = std::thread(&FlightRecorder::run, this);
+}
+
+FlightRecorder::~FlightRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+int64_t FlightRecorder::nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void FlightRecorder::recordFrame(int camIndex, int16_t ptat, const int16_t* pixels, int64_t timeUs) {
+    if (camIndex < 0 || camIndex >= MAX_CAMERAS)
+        return;
+
+    // The dump holds the ring while it writes it out; an acquisition thread
+    // must not wait for that. Frozen is checked again under the lock in case
+    // the trigger landed in between.
+    FrameRing& ring = frames[camIndex];
+    std::unique_lock<std::mutex> lock(ring.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || frozen.load(std::memory_order_relaxed)) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    FrameSlot& slot = ring.records[ring.next];
+    slot.timeUs = timeUs;
+    slot.seq = ring.seq++;
+    slot.ptat = ptat;
+    memcpy(&ring.pixels[ring.next * ThermalCameraManager::N_PIXEL], pixels,
+           ThermalCameraManager::N_PIXEL * sizeof(int16_t));
+    ring.next = (ring.next + 1) % ring.records.size();
+    if (ring.count < ring.records.size())
+        ++ring.count;
+}
+
+bool FlightRecorder::setAdcRate(double scansPerSecond) {
+    if (frozen.load() || !(scansPerSecond > 0))
+        return false;
+    std::lock_guard<std::mutex> lock(adcMutex);
+    adc.assign((size_t)(seconds * scansPerSecond) + 1, AdcSlot());
+    adcNext = 0;
+    adcCount = 0;
+    return true;
+}
+
+void FlightRecorder::recordAdc(const double* values, int count, int64_t timeUs, uint64_t seq) {
+    if (count > ADC_CHANNELS)
+        count = ADC_CHANNELS;
+
+    // As recordFrame(): never block the acquisition thread on a dump.
+    std::unique_lock<std::mutex> lock(adcMutex, std::try_to_lock);
+    if (!lock.owns_lock() || frozen.load(std::memory_order_relaxed)) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    AdcSlot& slot = adc[adcNext];
+    slot.timeUs = timeUs;
+    slot.seq = seq;
+    slot.count = count;
+    for (int i = 0; i < count; ++i)
+        slot.values[i] = values[i];
+    adcNext = (adcNext + 1) % adc.size();
+    if (adcCount < adc.size())
+        ++adcCount;
+}
+
+bool FlightRecorder::trigger(const std::string& why) {
+    bool expected = false;
+    if (!frozen.compare_exchange_strong(expected, true))
+        return false;
+
+    using namespace std::chrono;
+    {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        reason = why;
+        triggerUs = nowUs();
+        triggerWallMs = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+        dumpPending = true;
+    }
+    wake.notify_one();
+    return true;
+}
+
+void FlightRecorder::rearm() {
+    // A dump in progress is still reading the rings; it unfreezes them itself.
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    if (dumpPending)
+        rearmAfterDump = true;
+    else
+        frozen.store(false);
+}
+
+void FlightRecorder::run() {
+    std::unique_lock<std::mutex> lock(dumpMutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || dumpPending; });
+        if (!dumpPending)
+            return;
+
+        std::string why = reason;
+        int64_t steadyUs = triggerUs;
+        int64_t wallMs = triggerWallMs;
+        lock.unlock();
+        dump(why, steadyUs, wallMs);
+        lock.lock();
+        dumpPending = false;
+        if (rearmAfterDump) {
+            rearmAfterDump = false;
+            frozen.store(false);
+        }
+    }
+}
+
+void FlightRecorder::dump(const std::string& why, int64_t steadyUs, int64_t wallMs) {
+    constexpr int N_PIXEL = ThermalCameraManager::N_PIXEL;
+    constexpr int N_READ = ThermalCameraManager::N_READ;
+
+    time_t secs = (time_t)(wallMs / 1000);
+    struct tm t;
+    localtime_r(&secs, &t);
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s/trip_%04d%02d%02d_%02d%02d%02d_%03d", directory.c_str(),
+             t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+             (int)(wallMs % 1000));
+    mkdir(directory.c_str(), 0755);
+    if (mkdir(dir, 0755) != 0) {
+        perror("Failed to create flight recorder directory");
+        return;
+    }
+
+    char path[600];
+    snprintf(path, sizeof(path), "%s/thermal.raw", dir);
+    FILE* raw = fopen(path, "wb");
+    snprintf(path, sizeof(path), "%s/frames.csv", dir);
+    FILE* csv = fopen(path, "w");
+    if (!raw || !csv) {
+        perror("Failed to open flight recorder output");
+        if (raw) fclose(raw);
+        if (csv) fclose(csv);
+        return;
+    }
+    fprintf(csv, "time_us,camera,seq,ptat_c,max_c\n");
+
+    // Merge the camera rings oldest first. Each ring's lock is held for the
+    // whole dump; recorders skip rather than wait, so nothing blocks on it.
+    std::unique_lock<std::mutex> locks[MAX_CAMERAS];
+    size_t cursor[MAX_CAMERAS];
+    size_t frameTotal = 0;
+    for (int c = 0; c < MAX_CAMERAS; ++c) {
+        locks[c] = std::unique_lock<std::mutex>(frames[c].mutex);
+        cursor[c] = 0;
+        frameTotal += frames[c].count;
+    }
+
+    uint8_t rec[1 + N_READ];
+    for (size_t n = 0; n < frameTotal; ++n) {
+        int cam = -1;
+        size_t index = 0;
+        for (int c = 0; c < MAX_CAMERAS; ++c) {
+            const FrameRing& ring = frames[c];
+            if (cursor[c] >= ring.count)
+                continue;
+            size_t i = (ring.next + ring.records.size() - ring.count + cursor[c]) % ring.records.size();
+            if (cam < 0 || ring.records[i].timeUs < frames[cam].records[index].timeUs) {
+                cam = c;
+                index = i;
+            }
+        }
+        ++cursor[cam];
+
+        const FrameSlot& slot = frames[cam].records[index];
+        const int16_t* pixels = &frames[cam].pixels[index * N_PIXEL];
+
+        // Re-encode as the D6T's response so replay runs the normal path.
+        uint8_t* frame = rec + 1;
+        rec[0] = (uint8_t)cam;
+        frame[0] = (uint8_t)(slot.ptat & 0xFF);
+        frame[1] = (uint8_t)((uint16_t)slot.ptat >> 8);
+        int16_t maxPixel = INT16_MIN;
+        for (int p = 0; p < N_PIXEL; ++p) {
+            frame[2 + 2 * p] = (uint8_t)(pixels[p] & 0xFF);
+            frame[3 + 2 * p] = (uint8_t)((uint16_t)pixels[p] >> 8);
+            if (pixels[p] > maxPixel) maxPixel = pixels[p];
+        }
+        frame[N_READ - 1] = D6T_calcPEC(ThermalCameraManager::D6T_ADDR, frame, N_READ - 1);
+        fwrite(rec, 1, sizeof(rec), raw);
+
+        fprintf(csv, "%lld,%d,%u,%.1f,%.1f\n", (long long)slot.timeUs, cam, slot.seq,
+                slot.ptat / 10.0, maxPixel / 10.0);
+    }
+    for (auto& lock : locks)
+        lock.unlock();
+    fclose(raw);
+    fclose(csv);
+
+    size_t adcTotal = 0;
+    snprintf(path, sizeof(path), "%s/adc.csv", dir);
+    if (FILE* out = fopen(path, "w")) {
+        std::lock_guard<std::mutex> lock(adcMutex);
+        fprintf(out, "time_us,seq,ch0,ch1,ch2,ch3\n");
+        for (size_t n = 0; n < adcCount; ++n) {
+            const AdcSlot& slot = adc[(adcNext + adc.size() - adcCount + n) % adc.size()];
+            fprintf(out, "%lld,%llu", (long long)slot.timeUs, (unsigned long long)slot.seq);
+            for (int i = 0; i < ADC_CHANNELS; ++i) {
+                if (i < slot.count) fprintf(out, ",%.6f", slot.values[i]);
+                else fprintf(out, ",");
+            }
+            fprintf(out, "\n");
+        }
+        adcTotal = adcCount;
+        fclose(out);
+    }
+
+    snprintf(path, sizeof(path), "%s/info.txt", dir);
+    if (FILE* out = fopen(path, "w")) {
+        fprintf(out, "reason: %s\nframes: %zu\nadc_samples: %zu\ntrigger_time_us: %lld\n",
+                why.c_str(), frameTotal, adcTotal, (long long)steadyUs);
+        fclose(out);
+    }
+
+    dumps.fetch_add(1);
+    fprintf(stderr, "Flight recorder dumped %zu frames, %zu ADC samples to %s\n", frameTotal, adcTotal, dir);
+}
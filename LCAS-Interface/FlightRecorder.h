@@ -0,0 +1,105 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pre-trigger history of raw thermal frames and ADC samples. Every ring is
+// allocated up front and recording is a copy into the next slot, so steady
+// state never touches the heap or the disk. trigger() freezes all rings and
+// a background thread dumps them to flight_recorder/trip_<time>/:
+//   thermal.raw  camera records in RecordingThermalBus format (replayable
+//                through LCAS_THERMAL_REPLAY), oldest first
+//   frames.csv   per-frame time, camera, sequence, PTAT and max
+//   adc.csv      per-scan capture time, sequence and channel values
+//   info.txt     trigger reason and counts
+// The rings stay frozen until rearm(), normally from the trip reset button.
+class FlightRecorder {
+public:
+    static constexpr int MAX_CAMERAS = 4;
+    static constexpr int ADC_CHANNELS = 4;
+
+    // adcRateHz is only a starting size; setAdcRate() fits the ring to the
+    // scan plan once the ADC is running.
+    explicit FlightRecorder(double seconds = 10.0, int frameRateHz = 20, int adcRateHz = 2000,
+                            const std::string& directory = "flight_recorder");
+    ~FlightRecorder();   // finishes a pending dump, then joins
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Both are safe to call from any thread, take the capture time, and
+    // never wait on a dump: while frozen (or while the dump holds the ring)
+    // they count the record as skipped and return.
+    void recordFrame(int camIndex, int16_t ptat, const int16_t* pixels, int64_t timeUs);
+    void recordAdc(const double* values, int count, int64_t timeUs, uint64_t seq);
+
+    // Resizes the ADC ring to hold the full history at this many scans a
+    // second, dropping what it holds. False while frozen.
+    bool setAdcRate(double scansPerSecond);
+
+    // Freezes the rings and schedules a dump. Returns false if already frozen.
+    bool trigger(const std::string& reason);
+    void rearm();
+    bool isFrozen() const { return frozen.load(); }
+
+    uint64_t dumpCount() const { return dumps.load(); }
+    uint64_t skippedCount() const { return skipped.load(); }
+
+private:
+    struct FrameSlot {
+        int64_t timeUs;
+        uint32_t seq;
+        int16_t ptat;
+    };
+
+    struct FrameRing {
+        std::mutex mutex;
+        std::vector<FrameSlot> records;
+        std::vector<int16_t> pixels;   // records.size() * N_PIXEL
+        size_t next = 0;
+        size_t count = 0;
+        uint32_t seq = 0;
+    };
+
+    struct AdcSlot {
+        int64_t timeUs;
+        uint64_t seq;
+        int count;
+        double values[ADC_CHANNELS];
+    };
+
+    std::string directory;
+    double seconds;
+    FrameRing frames[MAX_CAMERAS];
+
+    std::mutex adcMutex;
+    std::vector<AdcSlot> adc;
+    size_t adcNext = 0;
+    size_t adcCount = 0;
+
+    std::atomic<bool> frozen{false};
+    std::atomic<uint64_t> dumps{0};
+    std::atomic<uint64_t> skipped{0};
+
+    std::mutex dumpMutex;
+    std::condition_variable wake;
+    bool dumpPending = false;
+    bool rearmAfterDump = false;
+    bool stopping = false;
+    std::string reason;
+    int64_t triggerUs = 0;
+    int64_t triggerWallMs = 0;
+    std::thread worker;
+
+    static int64_t nowUs();
+    void run();
+    void dump(const std::string& why, int64_t steadyUs, int64_t wallMs);
+};
+
+#endif // FLIGHT_RECORDER_H
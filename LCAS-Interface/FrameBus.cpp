@@ -0,0 +1,206 @@
+#include "FrameBus.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<ThermalFrame>::value, "frames are copied as bytes");
+static_assert(std::is_trivially_copyable<AdcSample>::value, "scans are copied as bytes");
+
+static constexpr int READ_ATTEMPTS = 4;
+
+FrameBus::~FrameBus() {
+    close();
+}
+
+bool FrameBus::create(const char* name) {
+    return map(name, true);
+}
+
+bool FrameBus::attach(const char* name) {
+    return map(name, false);
+}
+
+int FrameBus::liveWriter(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return 0;
+    struct stat st;
+    void* mem = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Layout))
+        mem = mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED)
+        return 0;
+    const Layout* old = static_cast<const Layout*>(mem);
+    int pid = 0;
+    // A writer that died without closing leaves live set; its pid is gone.
+    if (old->magic == MAGIC && old->version == VERSION && old->live.load(std::memory_order_acquire) &&
+        old->writerPid > 0 && (kill(old->writerPid, 0) == 0 || errno == EPERM))
+        pid = old->writerPid;
+    munmap(mem, sizeof(Layout));
+    return pid;
+}
+
+bool FrameBus::map(const char* name, bool create) {
+    close();
+    if (create) {
+        if (int pid = liveWriter(name)) {
+            fprintf(stderr, "Frame bus %s is in use by pid %d; not replacing it\n", name, pid);
+            return false;
+        }
+        // A new object rather than the old one rewritten under live readers.
+        shm_unlink(name);
+    }
+    int fd = create ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644) : shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        if (create) perror("shm_open frame bus");
+        return false;
+    }
+    if (create && ftruncate(fd, sizeof(Layout)) < 0) {
+        perror("ftruncate frame bus");
+        ::close(fd);
+        return false;
+    }
+    if (!create) {
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(Layout)) {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    void* mem = mmap(nullptr, sizeof(Layout), create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        perror("mmap frame bus");
+        return false;
+    }
+    layout = static_cast<Layout*>(mem);
+
+    if (create) {
+        memset(mem, 0, sizeof(Layout));
+        layout->version = VERSION;
+        layout->size = sizeof(Layout);
+        layout->cameras = CAMERAS;
+        layout->frameSlots = FRAME_SLOTS;
+        layout->adcSlots = ADC_SLOTS;
+        layout->writerPid = (int32_t)getpid();
+        layout->live.store(1, std::memory_order_relaxed);
+        // Readers check the magic last, so it goes in last.
+        std::atomic_thread_fence(std::memory_order_release);
+        layout->magic = MAGIC;
+    } else if (layout->magic != MAGIC || layout->version != VERSION || layout->size != sizeof(Layout)) {
+        fprintf(stderr, "Frame bus %s has an incompatible layout\n", name);
+        close();
+        return false;
+    }
+    owner = create;
+    snprintf(shmName, sizeof(shmName), "%s", name);
+    return true;
+}
+
+void FrameBus::close() {
+    if (!layout)
+        return;
+    if (owner)
+        layout->live.store(0, std::memory_order_release);
+    munmap(layout, sizeof(Layout));
+    layout = nullptr;
+    if (owner)
+        shm_unlink(shmName);
+    owner = false;
+}
+
+bool FrameBus::writerAlive() const {
+    return layout && layout->live.load(std::memory_order_acquire);
+}
+
+template <typename T, int N>
+void FrameBus::write(Ring<T, N>& ring, const T& value) {
+    uint64_t n = ring.head.load(std::memory_order_relaxed);
+    Slot<T>& slot = ring.items[n % N];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.value, &value, sizeof(T));
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    ring.head.store(n + 1, std::memory_order_release);
+}
+
+template <typename T, int N>
+bool FrameBus::read(const Ring<T, N>& ring, Cursor& cursor, T& out, bool latest) {
+    for (int attempt = 0; attempt < READ_ATTEMPTS; ++attempt) {
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        if (head <= cursor.next)
+            return false;
+        uint64_t n = latest ? head - 1 : cursor.next;
+        if (head - n > (uint64_t)N) {
+            // Lapped: resume at the oldest item still in the ring.
+            cursor.lost += head - N - n;
+            n = head - N;
+        }
+        const Slot<T>& slot = ring.items[n % N];
+        uint64_t ready = 2 * n + 2;
+        if (slot.seq.load(std::memory_order_acquire) != ready)
+            continue;
+        memcpy(&out, &slot.value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != ready)
+            continue;
+        cursor.next = n + 1;
+        return true;
+    }
+    return false;
+}
+
+void FrameBus::publishFrame(const ThermalFrame& frame) {
+    if (layout && frame.camIndex >= 0 && frame.camIndex < CAMERAS)
+        write(layout->frames[frame.camIndex], frame);
+}
+
+void FrameBus::publishAdc(const AdcSample& sample) {
+    if (layout)
+        write(layout->adc, sample);
+}
+
+void FrameBus::publishAdcRates(const double* channelRate) {
+    if (!layout)
+        return;
+    Rates rates;
+    memcpy(rates.channelRate, channelRate, sizeof(rates.channelRate));
+    write(layout->rates, rates);
+}
+
+bool FrameBus::nextFrame(int camIndex, Cursor& cursor, ThermalFrame& out) const {
+    if (!layout || camIndex < 0 || camIndex >= CAMERAS)
+        return false;
+    return read(layout->frames[camIndex], cursor, out, false);
+}
+
+bool FrameBus::latestFrame(int camIndex, Cursor& cursor, ThermalFrame& out) const {
+    if (!layout || camIndex < 0 || camIndex >= CAMERAS)
+        return false;
+    return read(layout->frames[camIndex], cursor, out, true);
+}
+
+bool FrameBus::nextAdc(Cursor& cursor, AdcSample& out) const {
+    return layout && read(layout->adc, cursor, out, false);
+}
+
+bool FrameBus::latestAdc(Cursor& cursor, AdcSample& out) const {
+    return layout && read(layout->adc, cursor, out, true);
+}
+
+bool FrameBus::readAdcRates(double* channelRate) const {
+    Cursor cursor;
+    Rates rates;
+    if (!layout || !read(layout->rates, cursor, rates, true))
+        return false;
+    memcpy(channelRate, rates.channelRate, sizeof(rates.channelRate));
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <atomic>
+#include <cstdint>
+#include "ThermalFrame.h"
+#include "AdcAcquisition.h"
+
+// Recent thermal frames per camera and recent stray-light scans in POSIX
+// shared memory (/dev/shm), so viewers, loggers and analysis tools in other
+// processes can follow acquisition without it knowing they exist. One
+// process publishes; any number of readers map the same object read-only.
+//
+// Each stream is a ring of seqlock slots with a single writer. Item n goes
+// to slot n % size; the writer marks the slot 2n+1 while copying and 2n+2
+// when done, then advances the head, never waiting for anyone. A reader
+// keeps its own cursor: it copies the item it wants straight out of the
+// mapping and checks the slot still holds that item afterwards. Items the
+// writer has already overwritten are skipped and counted as lost.
+class FrameBus {
+public:
+    static constexpr const char* DEFAULT_NAME = "/lcas-frames";
+    static constexpr uint32_t MAGIC = 0x4C434653;   // "LCFS"
+    static constexpr uint32_t VERSION = 3;
+    static constexpr int CAMERAS = 4;
+    static constexpr int FRAME_SLOTS = 16;          // a few seconds per camera
+    static constexpr int ADC_SLOTS = 4096;          // about two seconds of scans
+
+    struct AdcStatus {
+        AdcSample sample;
+        double channelRate[AdcSample::MAX_CHANNELS] = {};   // good samples/s
+    };
+
+    // A reader's position in one stream.
+    struct Cursor {
+        uint64_t next = 0;      // sequence number of the next item to read
+        uint64_t lost = 0;      // items overwritten before they were read
+    };
+
+    FrameBus() = default;
+    ~FrameBus();
+
+    FrameBus(const FrameBus&) = delete;
+    FrameBus& operator=(const FrameBus&) = delete;
+
+    // The writer creates a fresh object (readers of a previous one keep
+    // their mapping and see it go stale); readers attach to an existing one
+    // and fail if it is missing or from another version. create() refuses
+    // to replace a bus whose writer is still running.
+    bool create(const char* name = DEFAULT_NAME);
+    bool attach(const char* name = DEFAULT_NAME);
+    void close();
+    bool isOpen() const { return layout != nullptr; }
+    bool writerAlive() const;   // false once the writer has closed the bus
+
+    // Writer side. One thread per stream: each camera has its own worker and
+    // the ADC has its acquisition thread.
+    void publishFrame(const ThermalFrame& frame);
+    void publishAdc(const AdcSample& sample);
+    void publishAdcRates(const double* channelRate);
+
+    // next*: the item at the cursor, oldest first; false once caught up.
+    // latest*: the newest item if it is past the cursor, skipping the rest
+    // without counting them lost.
+    bool nextFrame(int camIndex, Cursor& cursor, ThermalFrame& out) const;
+    bool latestFrame(int camIndex, Cursor& cursor, ThermalFrame& out) const;
+    bool nextAdc(Cursor& cursor, AdcSample& out) const;
+    bool latestAdc(Cursor& cursor, AdcSample& out) const;
+    bool readAdcRates(double* channelRate) const;
+
+private:
+    template <typename T>
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq;
+        T value;
+    };
+
+    template <typename T, int N>
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> head;     // items published
+        Slot<T> items[N];
+    };
+
+    struct Rates {
+        double channelRate[AdcSample::MAX_CHANNELS];
+    };
+
+    struct Layout {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size;
+        uint32_t cameras;
+        uint32_t frameSlots;
+        uint32_t adcSlots;
+        std::atomic<uint32_t> live;
+        int32_t writerPid;
+        Ring<ThermalFrame, FRAME_SLOTS> frames[CAMERAS];
+        Ring<AdcSample, ADC_SLOTS> adc;
+        Ring<Rates, 1> rates;
+    };
+
+    Layout* layout = nullptr;
+    bool owner = false;
+    char shmName[64] = {};
+
+    bool map(const char* name, bool create);
+    static int liveWriter(const char* name);    // pid, or 0 if none
+    template <typename T, int N>
+    static void write(Ring<T, N>& ring, const T& value);
+    template <typename T, int N>
+    static bool read(const Ring<T, N>& ring, Cursor& cursor, T& out, bool latest);
+};
+
+#endif // FRAME_BUS_H
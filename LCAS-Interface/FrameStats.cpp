@@ -0,0 +1,72 @@
+#include "FrameStats.h"
+#include "Simd.h"
+
+FrameStats computeFrameStats(const int16_t* pixels, int width, int height, int16_t threshold) {
+    const int n = width * height;
+    FrameStats stats;
+    stats.threshold = threshold;
+    if (n <= 0)
+        return stats;
+
+    // Per-lane running max (with the index where it was first seen), min,
+    // over-threshold count and a widened sum. Compare masks are -1 per lane,
+    // so subtracting them counts hits.
+    simd::i16x8 vmax = simd::splat(INT16_MIN);
+    simd::i16x8 vmaxIdx = simd::splat(0);
+    simd::i16x8 vmin = simd::splat(INT16_MAX);
+    simd::i16x8 vcount = simd::splat(0);
+    simd::i16x8 vidx = simd::iota();
+    simd::i32x4 vsum = simd::zero32();
+    const simd::i16x8 limit = simd::splat(threshold);
+    const simd::i16x8 step = simd::splat(simd::I16_LANES);
+
+    int i = 0;
+    for (; i + simd::I16_LANES <= n; i += simd::I16_LANES) {
+        simd::i16x8 v = simd::load(pixels + i);
+        simd::i16x8 higher = simd::cmpgt(v, vmax);
+        vmaxIdx = simd::select(higher, vidx, vmaxIdx);
+        vmax = simd::max(vmax, v);
+        vmin = simd::min(vmin, v);
+        vcount = simd::sub(vcount, simd::cmpgt(v, limit));
+        vsum = simd::addPairs(vsum, v);
+        vidx = simd::add(vidx, step);
+    }
+
+    int16_t laneMax[simd::I16_LANES], laneIdx[simd::I16_LANES];
+    int16_t laneMin[simd::I16_LANES], laneCount[simd::I16_LANES];
+    simd::store(laneMax, vmax);
+    simd::store(laneIdx, vmaxIdx);
+    simd::store(laneMin, vmin);
+    simd::store(laneCount, vcount);
+
+    int16_t maxVal = INT16_MIN, minVal = INT16_MAX;
+    int maxIndex = n;
+    int count = 0;
+    if (i > 0) {
+        for (int l = 0; l < simd::I16_LANES; ++l) {
+            if (laneMax[l] > maxVal || (laneMax[l] == maxVal && laneIdx[l] < maxIndex)) {
+                maxVal = laneMax[l];
+                maxIndex = laneIdx[l];
+            }
+            if (laneMin[l] < minVal) minVal = laneMin[l];
+            count += laneCount[l];
+        }
+    }
+    int64_t sum = simd::hsum(vsum);
+
+    for (; i < n; ++i) {
+        int16_t v = pixels[i];
+        if (v > maxVal) { maxVal = v; maxIndex = i; }
+        if (v < minVal) minVal = v;
+        if (v > threshold) ++count;
+        sum += v;
+    }
+
+    stats.max = maxVal;
+    stats.min = minVal;
+    stats.mean = (double)sum / n;
+    stats.maxX = maxIndex % width;
+    stats.maxY = maxIndex / width;
+    stats.overThreshold = count;
+    return stats;
+}
@@ -0,0 +1,24 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <cstdint>
+
+// Summary of one thermal frame, all temperatures in 0.1 degC.
+struct FrameStats {
+    int16_t max = 0;
+    int16_t min = 0;
+    double mean = 0.0;
+    int maxX = -1;          // column of the first hottest pixel
+    int maxY = -1;          // row of the first hottest pixel
+    int16_t threshold = 0;  // threshold the count was taken against
+    int overThreshold = 0;  // pixels strictly above threshold
+
+    bool exceeded() const { return overThreshold > 0; }
+};
+
+// One vector pass over a row-major frame computing max, argmax, min, mean and
+// the over-threshold count. The argmax lanes hold absolute int16 pixel
+// indices, so width * height must not exceed 32767.
+FrameStats computeFrameStats(const int16_t* pixels, int width, int height, int16_t threshold);
+
+#endif // FRAME_STATS_H
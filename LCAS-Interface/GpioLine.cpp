@@ -0,0 +1,147 @@
+#include "GpioLine.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+static int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+GpioLine::~GpioLine() {
+    close();
+}
+
+bool GpioLine::request(const char* chip, int offset, uint64_t flags, int value, const char* consumer) {
+    close();
+    int chipFd = ::open(chip, O_RDONLY);
+    if (chipFd < 0) { perror("open gpiochip"); return false; }
+
+    struct gpio_v2_line_request req = {};
+    req.offsets[0] = offset;
+    req.num_lines = 1;
+    req.config.flags = flags;
+    if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+        req.config.num_attrs = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = value ? 1 : 0;
+        req.config.attrs[0].mask = 1;
+    }
+    strncpy(req.consumer, consumer, sizeof(req.consumer) - 1);
+
+    if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        fprintf(stderr, "GPIO: cannot request line %d as %s: %s\n", offset, consumer, strerror(errno));
+        ::close(chipFd);
+        return false;
+    }
+    ::close(chipFd);
+    fd = req.fd;
+    return true;
+}
+
+bool GpioLine::requestOutput(const char* chip, int offset, int value, const char* consumer) {
+    return request(chip, offset, GPIO_V2_LINE_FLAG_OUTPUT, value, consumer);
+}
+
+bool GpioLine::requestInput(const char* chip, int offset, Edge edge, const char* consumer) {
+    uint64_t flags = GPIO_V2_LINE_FLAG_INPUT;
+    if (edge == Edge::Rising) flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+    if (edge == Edge::Falling) flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    return request(chip, offset, flags, 0, consumer);
+}
+
+void GpioLine::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+static void recordMax(std::atomic<int64_t>& max, int64_t ns) {
+    int64_t seen = max.load(std::memory_order_relaxed);
+    while (ns > seen && !max.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void GpioLine::setMetricStages(Metrics::Stage set, Metrics::Stage get) {
+    setStage = set;
+    getStage = get;
+    timed = true;
+}
+
+bool GpioLine::set(int value) {
+    int64_t t0 = steadyNs();
+    struct gpio_v2_line_values values = {value ? 1ull : 0ull, 1};
+    bool ok = fd >= 0 && ioctl(fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == 0;
+    int64_t ns = steadyNs() - t0;
+
+    writes.fetch_add(1, std::memory_order_relaxed);
+    if (!ok)
+        failures.fetch_add(1, std::memory_order_relaxed);
+    lastNs.store(ns, std::memory_order_relaxed);
+    recordMax(maxNs, ns);
+    if (timed)
+        metrics.record(setStage, ns);
+    return ok;
+}
+
+int GpioLine::get() const {
+    int64_t t0 = steadyNs();
+    struct gpio_v2_line_values values = {0, 1};
+    bool ok = fd >= 0 && ioctl(fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0;
+    int64_t ns = steadyNs() - t0;
+
+    reads.fetch_add(1, std::memory_order_relaxed);
+    if (!ok)
+        readFailures.fetch_add(1, std::memory_order_relaxed);
+    lastReadNs.store(ns, std::memory_order_relaxed);
+    recordMax(maxReadNs, ns);
+    if (timed)
+        metrics.record(getStage, ns);
+    return ok ? (int)(values.bits & 1) : -1;
+}
+
+int GpioLine::waitEdge(int timeoutMs, int64_t* timestampUs) {
+    if (fd < 0)
+        return -1;
+
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int res = poll(&pfd, 1, timeoutMs);
+    if (res <= 0)
+        return res;
+
+    struct gpio_v2_line_event event;
+    if (read(fd, &event, sizeof(event)) != sizeof(event)) {
+        perror("read GPIO line event");
+        return -1;
+    }
+    if (timestampUs)
+        *timestampUs = (int64_t)(event.timestamp_ns / 1000);
+    return 1;
+}
+
+void GpioLine::drainEdges() {
+    if (fd < 0)
+        return;
+    struct pollfd pfd = {fd, POLLIN, 0};
+    struct gpio_v2_line_event event;
+    while (poll(&pfd, 1, 0) > 0 && read(fd, &event, sizeof(event)) == sizeof(event)) {}
+}
+
+GpioLine::Stats GpioLine::stats() const {
+    Stats s;
+    s.writes = writes.load(std::memory_order_relaxed);
+    s.failures = failures.load(std::memory_order_relaxed);
+    s.lastNs = lastNs.load(std::memory_order_relaxed);
+    s.maxNs = maxNs.load(std::memory_order_relaxed);
+    s.reads = reads.load(std::memory_order_relaxed);
+    s.readFailures = readFailures.load(std::memory_order_relaxed);
+    s.lastReadNs = lastReadNs.load(std::memory_order_relaxed);
+    s.maxReadNs = maxReadNs.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,75 @@
+#ifndef GPIO_LINE_H
+#define GPIO_LINE_H
+
+#include <atomic>
+#include <cstdint>
+#include "Metrics.h"
+
+// Persistent handle to one gpiochip line, requested through the v2
+// character-device uAPI and held until close(). Setting or reading the line
+// is then one ioctl on the held descriptor: no chip open, no line request
+// and no child process per access.
+//
+// Lines keep timing counters for set() and get() so the interlock path can
+// be checked against its budget, and can feed them to the process metrics.
+// Inputs can be requested with edge detection;
+// v2 stamps events with CLOCK_MONOTONIC, the steady_clock base.
+class GpioLine {
+public:
+    enum class Edge { None, Rising, Falling };
+
+    struct Stats {
+        uint64_t writes = 0;
+        uint64_t failures = 0;
+        int64_t lastNs = 0;     // duration of the last set()
+        int64_t maxNs = 0;
+        uint64_t reads = 0;
+        uint64_t readFailures = 0;
+        int64_t lastReadNs = 0; // duration of the last get()
+        int64_t maxReadNs = 0;
+    };
+
+    GpioLine() = default;
+    ~GpioLine();
+
+    GpioLine(const GpioLine&) = delete;
+    GpioLine& operator=(const GpioLine&) = delete;
+
+    bool requestOutput(const char* chip, int offset, int value, const char* consumer);
+    bool requestInput(const char* chip, int offset, Edge edge, const char* consumer);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    // Also records every set() and get() duration under these stages.
+    void setMetricStages(Metrics::Stage setStage, Metrics::Stage getStage);
+
+    // Safe from any thread. set() returns false if the line is not held or
+    // the ioctl fails; get() returns 0/1, or -1 on failure.
+    bool set(int value);
+    int get() const;
+
+    // Edge events, for inputs requested with an edge: 1 with the edge time,
+    // 0 on timeout, -1 on error.
+    int waitEdge(int timeoutMs, int64_t* timestampUs);
+    void drainEdges();
+
+    Stats stats() const;
+
+private:
+    int fd = -1;
+
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<int64_t> lastNs{0};
+    std::atomic<int64_t> maxNs{0};
+    mutable std::atomic<uint64_t> reads{0};
+    mutable std::atomic<uint64_t> readFailures{0};
+    mutable std::atomic<int64_t> lastReadNs{0};
+    mutable std::atomic<int64_t> maxReadNs{0};
+    bool timed = false;
+    Metrics::Stage setStage = Metrics::Stage::SeedSet;
+    Metrics::Stage getStage = Metrics::Stage::SeedReadback;
+
+    bool request(const char* chip, int offset, uint64_t flags, int value, const char* consumer);
+};
+
+#endif // GPIO_LINE_H
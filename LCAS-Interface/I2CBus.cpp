@@ -0,0 +1,66 @@
+#include "I2CBus.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <cstdio>
+
+I2CBus::~I2CBus() {
+    close();
+}
+
+bool I2CBus::open(const char* device) {
+    close();
+    fd = ::open(device, O_RDWR);
+    if (fd < 0) {
+        perror("open i2c");
+        return false;
+    }
+
+    unsigned long funcs = 0;
+    protocolMangling = ioctl(fd, I2C_FUNCS, &funcs) == 0 &&
+                       (funcs & I2C_FUNC_PROTOCOL_MANGLING);
+    return true;
+}
+
+void I2CBus::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int I2CBus::write(uint8_t addr, const uint8_t* data, int length) {
+    if (fd < 0) return -1;
+    struct i2c_msg msg = {addr, 0, (uint16_t)length, const_cast<uint8_t*>(data)};
+    struct i2c_rdwr_ioctl_data ioctl_data = {&msg, 1};
+    return ioctl(fd, I2C_RDWR, &ioctl_data) == 1 ? 0 : -1;
+}
+
+int I2CBus::readReg(uint8_t addr, uint8_t reg, uint8_t* data, int len) {
+    if (fd < 0) return -1;
+    struct i2c_msg msgs[2] = {
+        {addr, 0, 1, &reg},
+        {addr, I2C_M_RD, (uint16_t)len, data}
+    };
+    struct i2c_rdwr_ioctl_data ioctl_data = {msgs, 2};
+    return ioctl(fd, I2C_RDWR, &ioctl_data) == 2 ? 0 : -1;
+}
+
+int I2CBus::selectAndReadReg(uint8_t muxAddr, uint8_t channelMask,
+                             uint8_t addr, uint8_t reg, uint8_t* data, int len) {
+    if (fd < 0) return -1;
+    if (!protocolMangling) {
+        if (write(muxAddr, &channelMask, 1) < 0) return -1;
+        return readReg(addr, reg, data, len);
+    }
+
+    struct i2c_msg msgs[3] = {
+        {muxAddr, I2C_M_STOP, 1, &channelMask},
+        {addr, 0, 1, &reg},
+        {addr, I2C_M_RD, (uint16_t)len, data}
+    };
+    struct i2c_rdwr_ioctl_data ioctl_data = {msgs, 3};
+    return ioctl(fd, I2C_RDWR, &ioctl_data) == 3 ? 0 : -1;
+}
@@ -0,0 +1,37 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <cstdint>
+
+// Persistent handle to one i2c-dev adapter. The device node is opened once and
+// every transfer goes through I2C_RDWR, so the target address travels with
+// each message and no per-access open/ioctl(I2C_SLAVE)/close is needed.
+class I2CBus {
+public:
+    I2CBus() = default;
+    ~I2CBus();
+
+    I2CBus(const I2CBus&) = delete;
+    I2CBus& operator=(const I2CBus&) = delete;
+
+    bool open(const char* device);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    // All transfers return 0 on success and -1 on failure.
+    int write(uint8_t addr, const uint8_t* data, int length);
+    int readReg(uint8_t addr, uint8_t reg, uint8_t* data, int len);
+
+    // Select a TCA9548A channel mask and read a register behind it in one
+    // I2C_RDWR message set. The mux only switches on a STOP, so the select
+    // message carries I2C_M_STOP when the adapter supports it; otherwise the
+    // select is issued as its own message set on the same open descriptor.
+    int selectAndReadReg(uint8_t muxAddr, uint8_t channelMask,
+                         uint8_t addr, uint8_t reg, uint8_t* data, int len);
+
+private:
+    int fd = -1;
+    bool protocolMangling = false;
+};
+
+#endif // I2C_BUS_H
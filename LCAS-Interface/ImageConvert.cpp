@@ -0,0 +1,13 @@
+#include "ImageConvert.h"
+#include <opencv2/imgproc.hpp>
+
+QImage matToQImage(const cv::Mat& mat) {
+    cv::Mat rgb;
+    if (mat.channels() == 1) {
+        cv::cvtColor(mat, rgb, cv::COLOR_GRAY2RGB);
+    } else {
+        cv::cvtColor(mat, rgb, cv::COLOR_BGR2RGB);
+    }
+    return QImage(rgb.data, rgb.cols, rgb.rows, rgb.step, QImage::Format_RGB888).copy();
+}
+
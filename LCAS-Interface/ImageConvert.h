@@ -0,0 +1,10 @@
+#ifndef IMAGE_CONVERT_H
+#define IMAGE_CONVERT_H
+
+#include <QImage>
+#include <opencv2/opencv.hpp>
+
+// Deep-copies an 8-bit BGR or grayscale Mat into an RGB888 QImage.
+QImage matToQImage(const cv::Mat& mat);
+
+#endif // IMAGE_CONVERT_H
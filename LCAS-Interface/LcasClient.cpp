@@ -0,0 +1,164 @@
+#include "LcasClient.h"
+#include <QDebug>
+#include <memory>
+
+LcasClient::LcasClient(QObject* parent) : LcasLink(parent) {
+    connect(&socket, &QLocalSocket::readyRead, this, &LcasClient::handleReadyRead);
+    connect(&socket, &QLocalSocket::connected, this, &LcasClient::handleConnected);
+    connect(&socket, &QLocalSocket::disconnected, this, &LcasClient::handleDisconnected);
+
+    connect(&frameTimer, &QTimer::timeout, this, &LcasClient::pollFrames);
+    reconnectTimer.setSingleShot(true);
+    connect(&reconnectTimer, &QTimer::timeout, this, [this]() {
+        socket.connectToServer(socketName);
+    });
+    // A failed retry reports an error rather than a disconnect.
+    connect(&socket, &QLocalSocket::errorOccurred, this, [this]() {
+        if (socket.state() == QLocalSocket::UnconnectedState && !socketName.isEmpty())
+            reconnectTimer.start(RECONNECT_MS);
+    });
+}
+
+LcasClient::~LcasClient() {
+    // Closing the socket below would otherwise schedule a reconnect.
+    socket.disconnect(this);
+}
+
+bool LcasClient::connectToDaemon(const QString& name, const char* frameBus, int timeoutMs,
+                                 QLocalSocket::LocalSocketError* error) {
+    busName = frameBus;
+    socket.connectToServer(name);
+    bool connected = socket.waitForConnected(timeoutMs);
+    if (!connected) {
+        if (error)
+            *error = socket.error();
+        socket.abort();
+        reconnectTimer.start(RECONNECT_MS);
+    }
+    socketName = name;
+    return connected;
+}
+
+void LcasClient::handleConnected() {
+    // A restarted daemon recreates the bus, so map it afresh every time.
+    if (!bus.attach(busName.constData()))
+        emit message("Frame bus unavailable; no live images");
+    for (FrameBus::Cursor& cursor : frameCursors)
+        cursor = FrameBus::Cursor();
+    adcCursor = FrameBus::Cursor();
+    haveAdc = false;
+    frameTimer.start(FRAME_POLL_MS);
+}
+
+void LcasClient::handleDisconnected() {
+    frameTimer.stop();
+    bus.close();
+    emit message("Lost connection to lcasd; retrying");
+    reconnectTimer.start(RECONNECT_MS);
+}
+
+QString LcasClient::describe() const {
+    if (socket.state() != QLocalSocket::ConnectedState)
+        return QString("lcasd at %1 (not connected)").arg(socketName);
+    return QString("lcasd at %1").arg(socketName);
+}
+
+double LcasClient::adcThreshold(int channel) const {
+    return channel >= 0 && channel < ADC_CHANNELS ? adcThresholds[channel] : 0.0;
+}
+
+void LcasClient::send(const QByteArray& line) {
+    if (socket.state() != QLocalSocket::ConnectedState) {
+        emit message("Not connected to lcasd");
+        return;
+    }
+    socket.write(line + "\n");
+}
+
+void LcasClient::setTemperatureThreshold(double celsius) {
+    send("TEMP " + QByteArray::number(celsius));
+}
+
+void LcasClient::setAdcThreshold(int channel, double volts) {
+    send("ADCTHR " + QByteArray::number(channel) + " " + QByteArray::number(volts));
+}
+
+void LcasClient::setVoltage(const QString& address, double volts) {
+    send("PV " + address.toUtf8() + " " + QByteArray::number(volts, 'f', 3));
+}
+
+void LcasClient::setCurrent(const QString& address, double amps) {
+    send("PC " + address.toUtf8() + " " + QByteArray::number(amps, 'f', 3));
+}
+
+void LcasClient::enableOutput(const QString& address, bool on) {
+    send("OUT " + address.toUtf8() + (on ? " 1" : " 0"));
+}
+
+void LcasClient::emergencyStop() {
+    send("ESTOP");
+}
+
+void LcasClient::setSeedLocked(bool locked) {
+    send(locked ? "SEED 1" : "SEED 0");
+}
+
+void LcasClient::resetTrip() {
+    send("RESET");
+}
+
+bool LcasClient::latestAdc(FrameBus::AdcStatus& status) {
+    // The display only wants the newest scan; the rest stay in the ring.
+    if (bus.latestAdc(adcCursor, adc.sample)) {
+        bus.readAdcRates(adc.channelRate);
+        haveAdc = true;
+    }
+    if (!haveAdc)
+        return false;
+    status = adc;
+    return true;
+}
+
+void LcasClient::pollFrames() {
+    // Only the newest frame per camera, and only if it is new.
+    ThermalFrame frame;
+    for (int cam = 0; cam < FrameBus::CAMERAS; ++cam)
+        if (bus.latestFrame(cam, frameCursors[cam], frame))
+            emit frameReady(std::make_shared<const ThermalFrame>(frame));
+}
+
+void LcasClient::handleReadyRead() {
+    while (socket.canReadLine())
+        handleLine(socket.readLine().trimmed());
+}
+
+void LcasClient::handleLine(const QByteArray& line) {
+    int space = line.indexOf(' ');
+    QByteArray event = line.left(space);
+    QByteArray rest = space < 0 ? QByteArray() : line.mid(space + 1);
+    QList<QByteArray> words = rest.split(' ');
+
+    if (event == "TEMP") {
+        temperature = rest.toDouble();
+        emit thresholdsChanged();
+    } else if (event == "ADCTHR" && words.size() == 2) {
+        int channel = words[0].toInt();
+        if (channel >= 0 && channel < ADC_CHANNELS) {
+            adcThresholds[channel] = words[1].toDouble();
+            emit thresholdsChanged();
+        }
+    } else if (event == "TRIP") {
+        int split = rest.indexOf(' ');
+        emit tripped(QString::fromUtf8(rest.mid(split + 1)), rest.left(split).toLongLong());
+    } else if (event == "SHUTDOWN" && words.size() == 2) {
+        emit shutdownFinished(words[0] == "1", words[1].toLongLong());
+    } else if (event == "PS" && words.size() == 3) {
+        emit supplyTelemetry(QString::fromUtf8(words[0]), words[1].toDouble(), words[2].toDouble());
+    } else if (event == "SEED" && words.size() == 2) {
+        emit seedChanged(words[0] == "1", words[1] == "1");
+    } else if (event == "MSG" || event == "ERR") {
+        emit message(QString::fromUtf8(rest));
+    } else {
+        qWarning() << "lcasd sent an unknown event:" << line;
+    }
+}
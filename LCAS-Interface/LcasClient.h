@@ -0,0 +1,69 @@
+#ifndef LCAS_CLIENT_H
+#define LCAS_CLIENT_H
+
+#include <QLocalSocket>
+#include <QTimer>
+#include "LcasLink.h"
+#include "FrameBus.h"
+
+// A viewer's end of lcasd: commands and events over the control socket
+// (see LcasServer for the protocol), frames and ADC scans copied out of the
+// FrameBus on a timer. Nothing here can slow the daemon down; a viewer that
+// falls behind just skips frames.
+//
+// Thresholds are the daemon's: the setters send a request and the cached
+// values change when the daemon confirms.
+class LcasClient : public LcasLink {
+    Q_OBJECT
+public:
+    static constexpr int FRAME_POLL_MS = 50;
+    static constexpr int RECONNECT_MS = 1000;
+
+    explicit LcasClient(QObject* parent = nullptr);
+    ~LcasClient() override;
+
+    // Blocks up to timeoutMs. On failure `error` says why and the client
+    // keeps retrying in the background, unless the caller drops it.
+    bool connectToDaemon(const QString& socketName, const char* busName, int timeoutMs,
+                         QLocalSocket::LocalSocketError* error = nullptr);
+
+    QString describe() const override;
+    double temperatureThreshold() const override { return temperature; }
+    double adcThreshold(int channel) const override;
+    void setTemperatureThreshold(double celsius) override;
+    void setAdcThreshold(int channel, double volts) override;
+    void setVoltage(const QString& address, double volts) override;
+    void setCurrent(const QString& address, double amps) override;
+    void enableOutput(const QString& address, bool on) override;
+    void emergencyStop() override;
+    void setSeedLocked(bool locked) override;
+    void resetTrip() override;
+    bool latestAdc(FrameBus::AdcStatus& status) override;
+
+private slots:
+    void handleReadyRead();
+    void handleConnected();
+    void handleDisconnected();
+    void pollFrames();
+
+private:
+    QLocalSocket socket;
+    QTimer frameTimer;
+    QTimer reconnectTimer;
+    QString socketName;
+    QByteArray busName;
+
+    FrameBus bus;
+    FrameBus::Cursor frameCursors[FrameBus::CAMERAS];
+    FrameBus::Cursor adcCursor;
+    FrameBus::AdcStatus adc;
+    bool haveAdc = false;
+
+    double temperature = 0;
+    double adcThresholds[ADC_CHANNELS] = {};
+
+    void send(const QByteArray& line);
+    void handleLine(const QByteArray& line);
+};
+
+#endif // LCAS_CLIENT_H
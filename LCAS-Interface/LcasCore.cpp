@@ -0,0 +1,264 @@
+#include "LcasCore.h"
+#include "ThermalWorker.h"
+#include "PowerSupplyManager.h"
+#include "SupplyScheduler.h"
+#include "ShutdownSequencer.h"
+#include "Metrics.h"
+#include <QDebug>
+#include <cstdio>
+#include <cstdlib>
+
+LcasCore::LcasCore(QObject* parent) : LcasLink(parent) {
+    for (auto& threshold : adcThresholds)
+        threshold.store(DEFAULT_ADC_THRESHOLD);
+    thermalManager.setFlightRecorder(&flightRecorder);
+    safetyEngine.setFlightRecorder(&flightRecorder);
+    connect(&seedRetry, &QTimer::timeout, this, [this]() {
+        if (holdSeedLine()) {
+            seedRetry.stop();
+            emit message("Seed interlock line held");
+        }
+    });
+}
+
+LcasCore::~LcasCore() {
+    stop();
+}
+
+void LcasCore::configureFromEnvironment() {
+    thermalManager.setBackend(ThermalCameraManager::backendFromString(getenv("LCAS_THERMAL_BACKEND")));
+    thermalManager.setReplayFile(getenv("LCAS_THERMAL_REPLAY"));
+    thermalManager.setRecordFile(getenv("LCAS_THERMAL_RECORD"));
+    if (const char* budget = getenv("LCAS_SAFETY_BUDGET_US"))
+        safetyEngine.setLatencyBudgetUs(atoll(budget));
+    if (const char* filter = getenv("LCAS_ADC_FILTER")) {
+        // median,cicOrder,decimation,window
+        AdcFilterBank::Config config;
+        sscanf(filter, "%d,%d,%d,%d", &config.median, &config.cicOrder, &config.decimation, &config.window);
+        safetyEngine.setAdcFilter(config);
+    }
+    if (const char* tones = getenv("LCAS_ADC_TONES")) {
+        // Comma-separated modulation frequencies in Hz.
+        AdcToneDetector::Config config;
+        char* end = const_cast<char*>(tones);
+        while (config.tones < AdcToneDetector::MAX_TONES && *end) {
+            double hz = strtod(end, &end);
+            if (hz > 0)
+                config.toneHz[config.tones++] = hz;
+            if (*end) ++end;
+        }
+        if (const char* bandwidth = getenv("LCAS_ADC_TONE_BW"))
+            config.bandwidthHz = atof(bandwidth);
+        safetyEngine.setAdcTones(config);
+    }
+    if (const char* toneRms = getenv("LCAS_ADC_TONE_V"))
+        for (int ch = 0; ch < SafetyEngine::ADC_CHANNELS; ++ch)
+            safetyEngine.setAdcToneThreshold(ch, atof(toneRms));
+    if (const char* drift = getenv("LCAS_ADC_DRIFT_V"))
+        for (int ch = 0; ch < SafetyEngine::ADC_CHANNELS; ++ch)
+            safetyEngine.setAdcDriftLimit(ch, atof(drift));
+    adcAcquisition.setBackend(AdcAcquisition::backendFromString(getenv("LCAS_ADC_BACKEND")));
+    if (const char* noise = getenv("LCAS_ADC_NOISE_UV"))
+        adcAcquisition.setNoiseFloorUv(atof(noise));
+    if (const char* adc2 = getenv("LCAS_ADC2_CHANNELS"))
+        adcAcquisition.setAdc2Channels(atoi(adc2));
+}
+
+void LcasCore::start() {
+    if (started)
+        return;
+    started = true;
+
+    // Held for the life of the process so locking the seed is one ioctl.
+    // Starts unlocked; the shutdown sequence and the seed lock command lock it.
+    // Without it a trip cannot lock the seed, so say so now and keep trying.
+    seedLock.setMetricStages(Metrics::Stage::SeedSet, Metrics::Stage::SeedReadback);
+    if (!holdSeedLine()) {
+        emit message(protectionFault());
+        seedRetry.start(SEED_RETRY_MS);
+    }
+    if (!thermalManager.initialize())
+        emit message(QString("Thermal bus %1 did not open").arg(thermalManager.busName()));
+
+    // The supply driver and the shutdown sequence share one thread and one
+    // port; everything else only queues requests to them.
+    powerThread = new QThread(this);
+    powerSupply = new PowerSupplyManager();
+    shutdownSequencer = new ShutdownSequencer(powerSupply);
+    shutdownSequencer->setSeedLine(&seedLock);
+    supplyScheduler = new SupplyScheduler(powerSupply, {"06", "07"});
+    powerSupply->moveToThread(powerThread);
+    shutdownSequencer->moveToThread(powerThread);
+    supplyScheduler->moveToThread(powerThread);
+    powerThread->start();
+    QMetaObject::invokeMethod(powerSupply, "open", Qt::QueuedConnection,
+                              Q_ARG(QString, "/dev/ttyUSB0"), Q_ARG(int, 9600));
+    if (const char* poll = getenv("LCAS_SUPPLY_POLL_MS"))
+        supplyScheduler->setPollIntervalMs(atoi(poll));
+    QMetaObject::invokeMethod(supplyScheduler, "start", Qt::QueuedConnection);
+    connect(shutdownSequencer, &ShutdownSequencer::finished, this, &LcasLink::shutdownFinished);
+    connect(supplyScheduler, &SupplyScheduler::telemetry, this, &LcasLink::supplyTelemetry);
+
+    // The engine trips on its own thread; viewers are told afterwards.
+    for (int i = 0; i < ADC_CHANNELS; ++i)
+        safetyEngine.setAdcThreshold(i, adcThresholds[i].load());
+    ShutdownSequencer* sequencer = shutdownSequencer;
+    safetyEngine.setShutdownAction([sequencer](const QString&) {
+        QMetaObject::invokeMethod(sequencer, "start", Qt::QueuedConnection);
+    });
+    connect(&safetyEngine, &SafetyEngine::tripped, this, &LcasLink::tripped);
+    safetyEngine.start();
+
+    for (int i = 0; i < CAMERAS; ++i) {
+        thermalThreads[i] = new QThread(this);
+        thermalWorkers[i] = new ThermalWorker(i, &thermalManager, &safetyEngine);
+        thermalWorkers[i]->moveToThread(thermalThreads[i]);
+        // Published from the worker thread; viewers get it queued.
+        connect(thermalWorkers[i], &ThermalWorker::frameReady, this, [this](const ThermalFramePtr& frame) {
+            if (frameBus)
+                frameBus->publishFrame(*frame);
+        }, Qt::DirectConnection);
+        connect(thermalWorkers[i], &ThermalWorker::frameReady, this, &LcasLink::frameReady);
+        thermalThreads[i]->start();
+        QMetaObject::invokeMethod(thermalWorkers[i], "start", Qt::QueuedConnection);
+    }
+
+    // Stray-light samples go from the acquisition thread to the safety
+    // engine directly.
+    adcAcquisition.setSink([this](const AdcSample& sample) {
+        safetyEngine.submitAdc(sample.volts, sample.count, sample.timeUs, sample.fresh, sample.channelTimeUs);
+        flightRecorder.recordAdc(sample.volts, sample.count, sample.timeUs, sample.seq);
+        if (frameBus) {
+            frameBus->publishAdc(sample);
+            // Rates change slowly and stats() takes a lock.
+            if (sample.seq % RATE_PUBLISH_SCANS == 0)
+                frameBus->publishAdcRates(adcAcquisition.stats().channelRate);
+        }
+    });
+    if (!adcAcquisition.start()) {
+        emit message("Stray-light ADC unavailable");
+    } else {
+        qDebug() << "ADC device:" << adcAcquisition.deviceName();
+        // One scan per ADC1 round, with headroom for a faster chip.
+        double roundUs = adcAcquisition.plan().adc1RoundUs;
+        if (roundUs > 0)
+            flightRecorder.setAdcRate(1.25e6 / roundUs);
+    }
+}
+
+void LcasCore::stop() {
+    if (!started)
+        return;
+    started = false;
+    seedRetry.stop();
+
+    // Producers first, then the engine, so nothing can trip into the
+    // sequencer once it is being deleted.
+    adcAcquisition.stop();
+    for (int i = 0; i < CAMERAS; ++i) {
+        thermalThreads[i]->quit();
+        thermalThreads[i]->wait();
+        delete thermalWorkers[i];
+        delete thermalThreads[i];
+        thermalWorkers[i] = nullptr;
+        thermalThreads[i] = nullptr;
+    }
+    safetyEngine.stop();
+    safetyEngine.setShutdownAction(nullptr);
+    disconnect(&safetyEngine, &SafetyEngine::tripped, this, &LcasLink::tripped);
+
+    powerThread->quit();
+    powerThread->wait();
+    delete supplyScheduler;
+    delete shutdownSequencer;
+    delete powerSupply;
+    delete powerThread;
+    supplyScheduler = nullptr;
+    shutdownSequencer = nullptr;
+    powerSupply = nullptr;
+    powerThread = nullptr;
+}
+
+bool LcasCore::holdSeedLine() {
+    return seedLock.isOpen() ||
+           seedLock.requestOutput(ShutdownSequencer::GPIO_CHIP, ShutdownSequencer::SEED_LINE, 0, "seed_lock");
+}
+
+QString LcasCore::protectionFault() const {
+    if (started && !seedLock.isOpen())
+        return QString("Seed interlock line %1 not held; a trip cannot lock the seed").arg(ShutdownSequencer::SEED_LINE);
+    return QString();
+}
+
+QString LcasCore::describe() const {
+    QString text = QString("in-process, thermal bus %1, ADC %2").arg(thermalManager.busName()).arg(adcAcquisition.deviceName());
+    if (!started)
+        return text;
+    QString fault = protectionFault();
+    return fault.isEmpty() ? text + ", protected" : text + ", NOT PROTECTED: " + fault;
+}
+
+double LcasCore::temperatureThreshold() const {
+    return thermalManager.getThreshold();
+}
+
+double LcasCore::adcThreshold(int channel) const {
+    return channel >= 0 && channel < ADC_CHANNELS ? adcThresholds[channel].load() : DEFAULT_ADC_THRESHOLD;
+}
+
+void LcasCore::setTemperatureThreshold(double celsius) {
+    thermalManager.setThreshold(celsius);
+    qDebug() << "Temperature threshold set to" << celsius;
+    emit thresholdsChanged();
+}
+
+void LcasCore::setAdcThreshold(int channel, double volts) {
+    if (channel < 0 || channel >= ADC_CHANNELS)
+        return;
+    adcThresholds[channel].store(volts);
+    safetyEngine.setAdcThreshold(channel, volts);
+    emit thresholdsChanged();
+}
+
+void LcasCore::setVoltage(const QString& address, double volts) {
+    if (supplyScheduler)
+        supplyScheduler->setVoltage(address, volts);
+}
+
+void LcasCore::setCurrent(const QString& address, double amps) {
+    if (supplyScheduler)
+        supplyScheduler->setCurrent(address, amps);
+}
+
+void LcasCore::enableOutput(const QString& address, bool on) {
+    if (powerSupply)
+        powerSupply->enableOutput(address, on);
+}
+
+void LcasCore::emergencyStop() {
+    // Runs in the supply thread; shutdownFinished reports the outcome.
+    if (shutdownSequencer)
+        QMetaObject::invokeMethod(shutdownSequencer, "start", Qt::QueuedConnection);
+}
+
+void LcasCore::setSeedLocked(bool locked) {
+    int value = locked ? 1 : 0;
+    bool ok = seedLock.set(value) && seedLock.get() == value;
+    emit seedChanged(locked, ok);
+}
+
+void LcasCore::resetTrip() {
+    safetyEngine.reset();
+    if (powerSupply)
+        powerSupply->setLockout(false);
+    flightRecorder.rearm();
+}
+
+bool LcasCore::latestAdc(FrameBus::AdcStatus& status) {
+    if (!adcAcquisition.latest(status.sample))
+        return false;
+    AdcAcquisition::Stats stats = adcAcquisition.stats();
+    for (int i = 0; i < AdcSample::MAX_CHANNELS; ++i)
+        status.channelRate[i] = stats.channelRate[i];
+    return true;
+}
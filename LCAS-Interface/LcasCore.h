@@ -0,0 +1,88 @@
+#ifndef LCAS_CORE_H
+#define LCAS_CORE_H
+
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include "LcasLink.h"
+#include "FlightRecorder.h"
+#include "ThermalCameraManager.h"
+#include "SafetyEngine.h"
+#include "AdcAcquisition.h"
+#include "GpioLine.h"
+
+class PowerSupplyManager;
+class ShutdownSequencer;
+class SupplyScheduler;
+class ThermalWorker;
+
+// Acquisition, interlocks and supplies: the camera worker threads, the
+// stray-light ADC, the safety engine and the supply thread with its
+// shutdown sequence. lcasd runs one and serves it to viewers; thermal_gui
+// runs one in-process when no daemon is available. Nothing here depends on
+// a window being open.
+//
+// The hardware objects (cameras, safety engine, flight recorder, ADC, seed
+// line) are members, so a viewer attached to lcasd never creates them or
+// their threads.
+class LcasCore : public LcasLink {
+    Q_OBJECT
+public:
+    static constexpr int CAMERAS = 4;
+    static constexpr double DEFAULT_ADC_THRESHOLD = 6.0;   // volts, above full scale
+    static constexpr uint64_t RATE_PUBLISH_SCANS = 256;
+    static constexpr int SEED_RETRY_MS = 5000;
+
+    explicit LcasCore(QObject* parent = nullptr);
+    ~LcasCore() override;
+
+    // Applies the LCAS_* environment to the hardware; before start().
+    void configureFromEnvironment();
+
+    // Frames and scans are published from the acquisition threads.
+    void setFrameBus(FrameBus* bus) { frameBus = bus; }
+
+    void start();
+    void stop();
+
+    QString describe() const override;
+    QString protectionFault() const override;
+    double temperatureThreshold() const override;
+    double adcThreshold(int channel) const override;
+    void setTemperatureThreshold(double celsius) override;
+    void setAdcThreshold(int channel, double volts) override;
+    void setVoltage(const QString& address, double volts) override;
+    void setCurrent(const QString& address, double amps) override;
+    void enableOutput(const QString& address, bool on) override;
+    void emergencyStop() override;
+    void setSeedLocked(bool locked) override;
+    void resetTrip() override;
+    bool latestAdc(FrameBus::AdcStatus& status) override;
+
+private:
+    bool started = false;
+    FrameBus* frameBus = nullptr;
+
+    // Declared in dependency order; stop() quiesces them before they go.
+    FlightRecorder flightRecorder;
+    ThermalCameraManager thermalManager;
+    SafetyEngine safetyEngine;
+    AdcAcquisition adcAcquisition;
+    GpioLine seedLock;
+
+    std::atomic<double> adcThresholds[ADC_CHANNELS];
+    QTimer seedRetry;
+
+    bool holdSeedLine();
+
+    QThread* powerThread = nullptr;
+    PowerSupplyManager* powerSupply = nullptr;
+    ShutdownSequencer* shutdownSequencer = nullptr;
+    SupplyScheduler* supplyScheduler = nullptr;
+
+    QThread* thermalThreads[CAMERAS] = {};
+    ThermalWorker* thermalWorkers[CAMERAS] = {};
+};
+
+#endif // LCAS_CORE_H
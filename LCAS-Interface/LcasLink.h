@@ -0,0 +1,54 @@
+#ifndef LCAS_LINK_H
+#define LCAS_LINK_H
+
+#include <QObject>
+#include <QString>
+#include "ThermalFrame.h"
+#include "FrameBus.h"
+
+// What the GUI sees of acquisition, interlocks and supplies. LcasCore runs
+// them in the GUI's own process; LcasClient attaches to them in lcasd. The
+// window is written against this interface only, so it behaves the same
+// either way and can come and go without affecting protection when the
+// daemon owns it.
+//
+// Commands return at once; outcomes arrive through the signals, on the
+// thread the link lives in.
+class LcasLink : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int ADC_CHANNELS = 4;
+
+    using QObject::QObject;
+
+    virtual QString describe() const = 0;
+    // Empty while every interlock is in place, else what is missing.
+    virtual QString protectionFault() const { return QString(); }
+
+    virtual double temperatureThreshold() const = 0;
+    virtual double adcThreshold(int channel) const = 0;
+    virtual void setTemperatureThreshold(double celsius) = 0;
+    virtual void setAdcThreshold(int channel, double volts) = 0;
+
+    virtual void setVoltage(const QString& address, double volts) = 0;
+    virtual void setCurrent(const QString& address, double amps) = 0;
+    virtual void enableOutput(const QString& address, bool on) = 0;
+
+    virtual void emergencyStop() = 0;
+    virtual void setSeedLocked(bool locked) = 0;
+    virtual void resetTrip() = 0;
+
+    // Latest stray-light scan and achieved rates; false until the first.
+    virtual bool latestAdc(FrameBus::AdcStatus& status) = 0;
+
+signals:
+    void frameReady(const ThermalFramePtr& frame);
+    void thresholdsChanged();
+    void tripped(const QString& reason, qint64 latencyUs);
+    void shutdownFinished(bool verified, qint64 totalUs);
+    void supplyTelemetry(const QString& address, double volts, double amps);
+    void seedChanged(bool locked, bool ok);
+    void message(const QString& text);
+};
+
+#endif // LCAS_LINK_H
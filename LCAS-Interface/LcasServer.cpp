@@ -0,0 +1,127 @@
+#include "LcasServer.h"
+#include <QDebug>
+
+// Text fields are the last thing on a line and must stay on it.
+static QByteArray oneLine(const QString& text) {
+    QByteArray bytes = text.toUtf8();
+    bytes.replace('\n', ' ');
+    return bytes;
+}
+
+LcasServer::LcasServer(LcasLink* link, QObject* parent)
+    : QObject(parent), link(link) {
+    connect(&server, &QLocalServer::newConnection, this, &LcasServer::handleConnection);
+
+    connect(link, &LcasLink::thresholdsChanged, this, &LcasServer::handleThresholdsChanged);
+    connect(link, &LcasLink::tripped, this, [this](const QString& reason, qint64 latencyUs) {
+        broadcast("TRIP " + QByteArray::number(latencyUs) + " " + oneLine(reason));
+    });
+    connect(link, &LcasLink::shutdownFinished, this, [this](bool verified, qint64 totalUs) {
+        broadcast("SHUTDOWN " + QByteArray::number(verified ? 1 : 0) + " " + QByteArray::number(totalUs));
+    });
+    connect(link, &LcasLink::supplyTelemetry, this, [this](const QString& address, double volts, double amps) {
+        broadcast("PS " + address.toUtf8() + " " + QByteArray::number(volts, 'f', 3) + " "
+                  + QByteArray::number(amps, 'f', 3));
+    });
+    connect(link, &LcasLink::seedChanged, this, [this](bool locked, bool ok) {
+        broadcast("SEED " + QByteArray::number(locked ? 1 : 0) + " " + QByteArray::number(ok ? 1 : 0));
+    });
+    connect(link, &LcasLink::message, this, [this](const QString& text) {
+        broadcast("MSG " + oneLine(text));
+    });
+}
+
+bool LcasServer::listen(const QString& name) {
+    QLocalServer::removeServer(name);
+    // Viewers run as the operator, not necessarily as the daemon's user.
+    server.setSocketOptions(QLocalServer::UserAccessOption | QLocalServer::GroupAccessOption);
+    if (!server.listen(name)) {
+        qWarning() << "lcasd: cannot listen on" << name << ":" << server.errorString();
+        return false;
+    }
+    qDebug() << "lcasd: listening on" << server.fullServerName();
+    return true;
+}
+
+void LcasServer::handleConnection() {
+    while (QLocalSocket* client = server.nextPendingConnection()) {
+        clients.append(client);
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() {
+            while (client->canReadLine())
+                handleLine(client, client->readLine().trimmed());
+        });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            clients.removeAll(client);
+            client->deleteLater();
+        });
+        send(client, thresholdLines());
+        QString fault = link->protectionFault();
+        if (!fault.isEmpty())
+            send(client, "MSG " + oneLine(fault));
+    }
+}
+
+QByteArray LcasServer::thresholdLines() const {
+    QByteArray lines = "TEMP " + QByteArray::number(link->temperatureThreshold()) + "\n";
+    for (int ch = 0; ch < LcasLink::ADC_CHANNELS; ++ch)
+        lines += "ADCTHR " + QByteArray::number(ch) + " " + QByteArray::number(link->adcThreshold(ch)) + "\n";
+    lines.chop(1);
+    return lines;
+}
+
+void LcasServer::handleThresholdsChanged() {
+    broadcast(thresholdLines());
+}
+
+void LcasServer::handleLine(QLocalSocket* client, const QByteArray& line) {
+    QList<QByteArray> words = line.split(' ');
+    const QByteArray& command = words.first();
+    bool ok = true;
+
+    if (command == "TEMP" && words.size() == 2) {
+        double celsius = words[1].toDouble(&ok);
+        if (ok) link->setTemperatureThreshold(celsius);
+    } else if (command == "ADCTHR" && words.size() == 3) {
+        bool chOk = false;
+        int channel = words[1].toInt(&chOk);
+        double volts = words[2].toDouble(&ok);
+        ok = ok && chOk && channel >= 0 && channel < LcasLink::ADC_CHANNELS;
+        if (ok) link->setAdcThreshold(channel, volts);
+    } else if (command == "PV" && words.size() == 3) {
+        double volts = words[2].toDouble(&ok);
+        if (ok) link->setVoltage(QString::fromUtf8(words[1]), volts);
+    } else if (command == "PC" && words.size() == 3) {
+        double amps = words[2].toDouble(&ok);
+        if (ok) link->setCurrent(QString::fromUtf8(words[1]), amps);
+    } else if (command == "OUT" && words.size() == 3) {
+        link->enableOutput(QString::fromUtf8(words[1]), words[2] == "1");
+    } else if (command == "ESTOP") {
+        qWarning() << "lcasd: emergency stop requested by viewer";
+        link->emergencyStop();
+    } else if (command == "SEED" && words.size() == 2) {
+        link->setSeedLocked(words[1] == "1");
+    } else if (command == "RESET") {
+        link->resetTrip();
+    } else if (!line.isEmpty()) {
+        ok = false;
+    }
+
+    if (!ok)
+        send(client, "ERR bad command: " + line);
+}
+
+void LcasServer::send(QLocalSocket* client, const QByteArray& line) {
+    if (client->bytesToWrite() > MAX_BACKLOG) {
+        qWarning() << "lcasd: dropping viewer that stopped reading";
+        client->abort();
+        return;
+    }
+    client->write(line + "\n");
+}
+
+void LcasServer::broadcast(const QByteArray& line) {
+    // send() may drop a client, which edits the list.
+    const QList<QLocalSocket*> targets = clients;
+    for (QLocalSocket* client : targets)
+        send(client, line);
+}
@@ -0,0 +1,53 @@
+#ifndef LCAS_SERVER_H
+#define LCAS_SERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include "LcasLink.h"
+
+// lcasd's control socket. Each viewer gets one QLocalSocket carrying
+// newline-terminated text, numbers in C locale:
+//
+//   viewer -> daemon           daemon -> viewer
+//   TEMP <degC>                TEMP <degC>             on connect and change
+//   ADCTHR <ch> <V>            ADCTHR <ch> <V>         on connect and change
+//   PV <addr> <V>              TRIP <latencyUs> <reason>
+//   PC <addr> <A>              SHUTDOWN <0|1> <totalUs>
+//   OUT <addr> <0|1>           PS <addr> <V> <A>
+//   ESTOP                      SEED <locked> <ok>
+//   SEED <0|1>                 MSG <text>
+//   RESET                      ERR <text>
+//
+// Frames and ADC scans never go through here; viewers read them from the
+// FrameBus. Everything runs on the daemon's main thread, away from
+// acquisition, and a viewer that stops reading is dropped rather than
+// buffered for.
+class LcasServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr const char* DEFAULT_NAME = "lcasd";
+    static constexpr qint64 MAX_BACKLOG = 1 << 20;   // bytes queued per viewer
+
+    explicit LcasServer(LcasLink* link, QObject* parent = nullptr);
+
+    // Replaces a socket left behind by a daemon that did not exit cleanly.
+    bool listen(const QString& name = DEFAULT_NAME);
+
+private slots:
+    void handleConnection();
+    void handleThresholdsChanged();
+
+private:
+    LcasLink* link;
+    QLocalServer server;
+    QList<QLocalSocket*> clients;
+
+    QByteArray thresholdLines() const;
+    void handleLine(QLocalSocket* client, const QByteArray& line);
+    void send(QLocalSocket* client, const QByteArray& line);
+    void broadcast(const QByteArray& line);
+};
+
+#endif // LCAS_SERVER_H
@@ -0,0 +1,170 @@
+#include "Metrics.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+Metrics metrics;
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketOf(int64_t ns) {
+    if (ns < SUB_BUCKETS)
+        return ns < 0 ? 0 : (int)ns;
+    int exponent = 63 - __builtin_clzll((uint64_t)ns);
+    if (exponent > MAX_EXPONENT)
+        return BUCKETS - 1;
+    int sub = (int)(ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS * (exponent - SUB_BITS + 1) + sub;
+}
+
+int64_t LatencyHistogram::upperBoundNs(int bucket) {
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    int sub = bucket % SUB_BUCKETS;
+    return ((int64_t)(SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    if (ns < 0)
+        ns = 0;
+    buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add((uint64_t)ns, std::memory_order_relaxed);
+    int64_t max = maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::snapshot(Snapshot& out) const {
+    // The count is the sum of the buckets, so the two always agree.
+    out.count = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        out.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        out.count += out.buckets[i];
+    }
+    out.sumNs = sumNs.load(std::memory_order_relaxed);
+    out.maxNs = maxNs.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::countAtOrBelow(int64_t ns) const {
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS && upperBoundNs(i) <= ns; ++i)
+        total += buckets[i];
+    return total;
+}
+
+int64_t LatencyHistogram::Snapshot::quantileNs(double q) const {
+    if (count == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(q * (double)(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return upperBoundNs(i) < maxNs ? upperBoundNs(i) : maxNs;
+    }
+    return maxNs;
+}
+
+void Metrics::beginEStop(int64_t originNs) {
+    int64_t none = 0;
+    estopOriginNs.compare_exchange_strong(none, originNs, std::memory_order_relaxed);
+}
+
+void Metrics::endEStop() {
+    int64_t origin = estopOriginNs.exchange(0, std::memory_order_relaxed);
+    if (origin != 0)
+        record(Stage::EStop, nowNs() - origin);
+}
+
+int64_t Metrics::nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- Prometheus text format ----
+
+static const char* const STAGE_NAMES[Metrics::STAGE_COUNT] = {
+    "i2c_read", "decode", "evaluate", "render", "signal_delivery", "serial_round_trip", "estop",
+    "seed_set", "seed_readback",
+};
+
+static const struct {
+    const char* name;
+    const char* help;
+} COUNTER_INFO[Metrics::COUNTER_COUNT] = {
+    {"lcas_thermal_read_retries_total", "D6T read attempts after the first."},
+    {"lcas_thermal_pec_failures_total", "D6T reads whose PEC did not match."},
+    {"lcas_thermal_read_errors_total", "D6T reads the I2C bus failed."},
+    {"lcas_thermal_frames_unusable_total", "Frames that failed every read retry."},
+    {"lcas_thermal_frames_dropped_total", "Frames lost from the safety queue, never evaluated."},
+    {"lcas_adc_samples_dropped_total", "ADC scans lost from the safety queue."},
+    {"lcas_adc_read_errors_total", "ADS1263 SPI or checksum failures."},
+    {"lcas_supply_timeouts_total", "Supply commands that got no reply."},
+    {"lcas_thermal_alerts_dropped_total", "Alert images lost from the writer queue."},
+};
+
+// 1-2.5-5 steps from 1 us to 10 s. Fine buckets straddling a bound count
+// towards the next one, which is within the histogram's 6.25%.
+static const double LE_SECONDS[] = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3,
+    1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1, 2.5, 5, 10,
+};
+
+static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+static void append(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void append(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0)
+        out.append(line, n < (int)sizeof(line) ? n : (int)sizeof(line) - 1);
+}
+
+void Metrics::writePrometheus(std::string& out) const {
+    std::vector<LatencyHistogram::Snapshot> snapshots(STAGE_COUNT);
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        histograms[s].snapshot(snapshots[s]);
+
+    out += "# HELP lcas_stage_latency_seconds Time spent in each pipeline stage.\n"
+           "# TYPE lcas_stage_latency_seconds histogram\n";
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const LatencyHistogram::Snapshot& snap = snapshots[s];
+        for (double le : LE_SECONDS)
+            append(out, "lcas_stage_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n", STAGE_NAMES[s], le,
+                   (unsigned long long)snap.countAtOrBelow((int64_t)(le * 1e9 + 0.5)));
+        append(out, "lcas_stage_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n", STAGE_NAMES[s],
+               (unsigned long long)snap.count);
+        append(out, "lcas_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n", STAGE_NAMES[s], snap.sumNs / 1e9);
+        append(out, "lcas_stage_latency_seconds_count{stage=\"%s\"} %llu\n", STAGE_NAMES[s],
+               (unsigned long long)snap.count);
+    }
+
+    out += "# HELP lcas_stage_latency_quantile_seconds Quantiles from the full-resolution histogram.\n"
+           "# TYPE lcas_stage_latency_quantile_seconds gauge\n";
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        for (double q : QUANTILES)
+            append(out, "lcas_stage_latency_quantile_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n", STAGE_NAMES[s],
+                   q, snapshots[s].quantileNs(q) / 1e9);
+
+    out += "# HELP lcas_stage_latency_max_seconds Longest time recorded for each stage.\n"
+           "# TYPE lcas_stage_latency_max_seconds gauge\n";
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        append(out, "lcas_stage_latency_max_seconds{stage=\"%s\"} %.9f\n", STAGE_NAMES[s], snapshots[s].maxNs / 1e9);
+
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        append(out, "# HELP %s %s\n# TYPE %s counter\n", COUNTER_INFO[c].name, COUNTER_INFO[c].help,
+               COUNTER_INFO[c].name);
+        append(out, "%s %llu\n", COUNTER_INFO[c].name,
+               (unsigned long long)counters[c].load(std::memory_order_relaxed));
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Latency distribution with HDR-style log-linear buckets: exact below 16 ns,
+// then 16 buckets per power of two, so any recorded value is known to
+// within 1/16 (6.25%) up to about 18 minutes. Recording is a handful of
+// relaxed atomic adds, wait-free from any number of threads; readers take a
+// snapshot that may be a few records out of step between fields.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_EXPONENT = 40;         // 2^40 ns, about 1100 s
+    static constexpr int BUCKETS = SUB_BUCKETS * (MAX_EXPONENT - SUB_BITS + 2);
+
+    struct Snapshot {
+        uint64_t buckets[BUCKETS];
+        uint64_t count;
+        uint64_t sumNs;
+        int64_t maxNs;
+
+        uint64_t countAtOrBelow(int64_t ns) const;
+        int64_t quantileNs(double q) const;     // upper bound of the bucket holding it
+    };
+
+    LatencyHistogram();
+
+    void record(int64_t ns);
+    void snapshot(Snapshot& out) const;
+
+    static int bucketOf(int64_t ns);
+    static int64_t upperBoundNs(int bucket);
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<int64_t> maxNs{0};
+};
+
+// Per-stage latency histograms and event counters for the whole process,
+// read out in Prometheus text format by MetricsServer. Every hot path only
+// adds to atomics; formatting happens on the scraping side.
+//
+// E-stop latency runs from the origin of the stop (the capture time of the
+// sample that tripped, or the moment a manual stop was requested) to the
+// end of the shutdown sequence, with every output commanded off.
+class Metrics {
+public:
+    enum class Stage {
+        I2cRead,            // one D6T read attempt on the bus
+        Decode,             // raw bytes to pixels
+        Evaluate,           // safety engine verdict on one sample
+        Render,             // colorize, upscale and paint one camera
+        SignalDelivery,     // frame capture to the window's slot
+        SerialRoundTrip,    // supply command line to its reply
+        EStop,              // trip origin to shutdown complete
+        SeedSet,            // seed-lock GPIO write
+        SeedReadback,       // seed-lock GPIO read back
+    };
+    static constexpr int STAGE_COUNT = 9;
+
+    enum class Counter {
+        ReadRetries,        // D6T read attempts after the first
+        PecFailures,        // reads whose PEC did not match
+        ReadErrors,         // reads the bus itself failed
+        FramesUnusable,     // frames that failed every retry
+        FramesDropped,      // frames the safety engine never evaluated
+        AdcSamplesDropped,  // ADC scans lost from the safety queue
+        AdcReadErrors,      // ADS1263 SPI or checksum failures
+        SerialTimeouts,     // supply commands that got no reply
+        AlertsDropped,      // alert images lost from the writer's queue
+    };
+    static constexpr int COUNTER_COUNT = 9;
+
+    void record(Stage stage, int64_t ns) { histograms[(int)stage].record(ns); }
+    void count(Counter counter, uint64_t n = 1) {
+        counters[(int)counter].fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value(Counter counter) const { return counters[(int)counter].load(std::memory_order_relaxed); }
+    void snapshot(Stage stage, LatencyHistogram::Snapshot& out) const { histograms[(int)stage].snapshot(out); }
+
+    // The first origin since the last endEStop() wins.
+    void beginEStop(int64_t originNs);
+    void endEStop();
+
+    void writePrometheus(std::string& out) const;
+
+    static int64_t nowNs();     // steady_clock, same base as the *Us timestamps
+
+private:
+    LatencyHistogram histograms[STAGE_COUNT];
+    std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+    std::atomic<int64_t> estopOriginNs{0};
+};
+
+extern Metrics metrics;
+
+#endif // METRICS_H
@@ -0,0 +1,48 @@
+#include "MetricsServer.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QDebug>
+#include <string>
+
+MetricsServer::MetricsServer(QObject* parent) : QObject(parent) {
+    connect(&server, &QTcpServer::newConnection, this, &MetricsServer::handleConnection);
+}
+
+bool MetricsServer::listen(quint16 port) {
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "Metrics: cannot listen on port" << port << ":" << server.errorString();
+        return false;
+    }
+    qDebug().noquote() << QString("Metrics at http://127.0.0.1:%1/metrics").arg(port);
+    return true;
+}
+
+void MetricsServer::handleConnection() {
+    while (QTcpSocket* socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [socket]() {
+            // One request per connection; answer once the head is complete.
+            QByteArray head = socket->peek(MAX_REQUEST);
+            if (!head.contains("\r\n\r\n") && !head.contains("\n\n")) {
+                if (head.size() >= MAX_REQUEST)
+                    socket->abort();
+                return;
+            }
+            socket->readAll();
+
+            QByteArray status = "200 OK";
+            std::string body;
+            if (head.startsWith("GET /metrics ") || head.startsWith("GET / "))
+                metrics.writePrometheus(body);
+            else
+                status = "404 Not Found";
+            QByteArray response = "HTTP/1.0 " + status + "\r\n"
+                                  "Content-Type: text/plain; version=0.0.4\r\n"
+                                  "Content-Length: " + QByteArray::number((qulonglong)body.size()) + "\r\n"
+                                  "Connection: close\r\n\r\n";
+            response.append(body.data(), (int)body.size());
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include "Metrics.h"
+
+// Serves the process's Metrics at GET /metrics in Prometheus text format,
+// on loopback only. Runs on the thread it lives in (the main thread); a
+// scrape reads the atomics and never touches the acquisition threads.
+class MetricsServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr quint16 DEFAULT_PORT = 9478;
+    static constexpr int MAX_REQUEST = 8192;    // bytes of request head accepted
+
+    explicit MetricsServer(QObject* parent = nullptr);
+
+    bool listen(quint16 port = DEFAULT_PORT);
+
+private slots:
+    void handleConnection();
+
+private:
+    QTcpServer server;
+};
+
+#endif // METRICS_SERVER_H
@@ -1,107 +1,202 @@
 #include "PowerSupplyManager.h"
-#include <QThread>
+#include "Metrics.h"
+#include <QDebug>
 
 PowerSupplyManager::PowerSupplyManager(QObject* parent)
-    : QObject(parent), serial(new QSerialPort(this)) {
+    : QObject(parent), serial(new QSerialPort(this)), timer(this), quietTimer(this) {
     serial->setParity(QSerialPort::NoParity);
     serial->setStopBits(QSerialPort::OneStop);
     serial->setDataBits(QSerialPort::Data8);
+    serial->setFlowControl(QSerialPort::NoFlowControl);
+
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &PowerSupplyManager::handleTimeout);
+    quietTimer.setSingleShot(true);
+    connect(&quietTimer, &QTimer::timeout, this, &PowerSupplyManager::finishResync);
+    connect(serial, &QSerialPort::readyRead, this, &PowerSupplyManager::handleReadyRead);
 }
 
 PowerSupplyManager::~PowerSupplyManager() {
-    disconnect();
+    close();
 }
 
-bool PowerSupplyManager::connectToPort(const QString& portName, int baudRate) {
+bool PowerSupplyManager::open(const QString& portName, int baudRate) {
     serial->setPortName(portName);
     serial->setBaudRate(baudRate);
     if (!serial->open(QIODevice::ReadWrite)) {
-        emit errorOccurred("Failed to open port");
+        qDebug() << "Failed to open power serial port:" << serial->errorString();
+        emit errorOccurred("Failed to open port " + portName);
         return false;
     }
+    qDebug() << "Power serial port opened successfully.";
+    selectedAddress.clear();
+    pump();
     return true;
 }
 
-void PowerSupplyManager::disconnect() {
-    if (serial->isOpen()) {
+void PowerSupplyManager::close() {
+    if (serial->isOpen())
         serial->close();
-    }
-}
-
-QString PowerSupplyManager::makeCommand(const QString& cmd) const {
-    return cmd + "\r"; // Commands must end with CR (ASCII 13)
 }
 
-bool PowerSupplyManager::sendCommand(const QString& cmd, bool expectResponse) {
-    QString fullCmd = makeCommand(cmd);
-    serial->write(fullCmd.toUtf8());
-    if (!serial->waitForBytesWritten(100)) {
-        emit errorOccurred("Write timeout");
-        return false;
+quint64 PowerSupplyManager::submit(const QString& address, const QByteArray& command, Priority priority) {
+    if (lockedOut.load() && (priority == Priority::Setpoint || priority == Priority::Control)) {
+        qDebug() << "Supply lockout active — rejecting" << command << "for PS" << address;
+        return 0;
     }
 
-    if (expectResponse) {
-        return serial->waitForReadyRead(200);
-    }
-
-    // Allow time between commands per spec
-    QThread::msleep(100);
-    return true;
-}
-
-QString PowerSupplyManager::readResponse() {
-    if (!serial->waitForReadyRead(500))
-        return "";
-
-    QByteArray response = serial->readAll();
-    while (serial->waitForReadyRead(100)) {
-        response += serial->readAll();
+    Command cmd;
+    cmd.id = nextId.fetch_add(1);
+    cmd.address = address;
+    cmd.text = command;
+    std::deque<Command> discarded;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (priority == Priority::Safety) {
+            // Never let a stale setpoint follow a shutdown onto the wire.
+            for (Priority p : {Priority::Control, Priority::Setpoint}) {
+                auto& queue = queues[(int)p];
+                discarded.insert(discarded.end(), queue.begin(), queue.end());
+                queue.clear();
+            }
+        }
+        queues[(int)priority].push_back(cmd);
     }
-    return QString(response).trimmed();
+    for (const Command& dropped : discarded)
+        emit commandFinished(dropped.id, dropped.address, dropped.text, "discarded", false);
+    QMetaObject::invokeMethod(this, "pump", Qt::QueuedConnection);
+    return cmd.id;
 }
 
-bool PowerSupplyManager::setAddress(int address) {
-    currentAddress = address;
-    return sendCommand(QString("ADR %1").arg(address), true) &&
-           readResponse().contains("OK");
+quint64 PowerSupplyManager::setVoltage(const QString& address, double volts, Priority priority) {
+    return submit(address, QString("PV %1").arg(volts, 0, 'f', 2).toUtf8(), priority);
 }
 
-bool PowerSupplyManager::reset() {
-    return sendCommand("RST", true) && readResponse().contains("OK");
+quint64 PowerSupplyManager::setCurrent(const QString& address, double amps, Priority priority) {
+    return submit(address, QString("PC %1").arg(amps, 0, 'f', 2).toUtf8(), priority);
 }
 
-bool PowerSupplyManager::setRemoteMode() {
-    return sendCommand("RMT 1", true) && readResponse().contains("OK");
+quint64 PowerSupplyManager::enableOutput(const QString& address, bool on, Priority priority) {
+    return submit(address, on ? "OUT 1" : "OUT 0", priority);
 }
 
-bool PowerSupplyManager::setVoltage(double volts) {
-    return sendCommand(QString("PV %1").arg(volts), true) && readResponse().contains("OK");
+quint64 PowerSupplyManager::queryVoltage(const QString& address, Priority priority) {
+    return submit(address, "MV?", priority);
 }
 
-bool PowerSupplyManager::setCurrent(double amps) {
-    return sendCommand(QString("PC %1").arg(amps), true) && readResponse().contains("OK");
+quint64 PowerSupplyManager::queryCurrent(const QString& address, Priority priority) {
+    return submit(address, "MC?", priority);
 }
 
-bool PowerSupplyManager::enableOutput(bool on) {
-    return sendCommand(QString("OUT %1").arg(on ? 1 : 0), true) && readResponse().contains("OK");
-}
-
-QString PowerSupplyManager::queryVoltage() {
-    sendCommand("MV?", true);
-    return readResponse();
-}
-
-QString PowerSupplyManager::querySetVoltage() {
-    sendCommand("PV?", true);
-    return readResponse();
-}
-
-QString PowerSupplyManager::queryCurrent() {
-    sendCommand("MC?", true);
-    return readResponse();
+bool PowerSupplyManager::takeNext(Command& out) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (auto& queue : queues) {
+        if (!queue.empty()) {
+            out = queue.front();
+            queue.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void PowerSupplyManager::pump() {
+    if (busy || resyncing)
+        return;
+    if (!serial->isOpen()) {
+        // Fail fast so callers waiting on a reply (the shutdown sequence)
+        // move on instead of hanging.
+        Command dropped;
+        while (takeNext(dropped))
+            emit commandFinished(dropped.id, dropped.address, dropped.text, "port closed", false);
+        return;
+    }
+    if (!takeNext(inFlight))
+        return;
+
+    busy = true;
+    sentNs = Metrics::nowNs();
+    addressing = inFlight.address != selectedAddress;
+    if (addressing)
+        sendLine("ADR " + inFlight.address.toUtf8());
+    else
+        sendLine(inFlight.text);
+}
+
+void PowerSupplyManager::sendLine(const QByteArray& line) {
+    rx.clear();
+    QByteArray framed = line;
+    framed.append("\r", 1);
+    serial->write(framed);
+    timer.start(replyTimeoutMs);
+}
+
+void PowerSupplyManager::handleReadyRead() {
+    if (resyncing) {
+        // A late reply to the timed-out command; wait for the line to settle.
+        serial->readAll();
+        rx.clear();
+        if (Metrics::nowNs() - resyncStartNs < RESYNC_MAX_MS * 1000000LL)
+            quietTimer.start(RESYNC_QUIET_MS);
+        return;
+    }
+    rx.append(serial->readAll());
+    int end;
+    while ((end = rx.indexOf('\r')) >= 0) {
+        QByteArray reply = rx.left(end).trimmed();
+        rx.remove(0, end + 1);
+        if (!busy)
+            continue;   // unsolicited, nothing outstanding
+        timer.stop();
+
+        if (addressing) {
+            addressing = false;
+            if (reply != "OK") {
+                selectedAddress.clear();
+                complete("ADR " + reply, false);
+                return;
+            }
+            selectedAddress = inFlight.address;
+            sendLine(inFlight.text);
+            return;
+        }
+
+        // Including the ADR exchange, if the command needed one.
+        metrics.record(Metrics::Stage::SerialRoundTrip, Metrics::nowNs() - sentNs);
+        // Set commands answer OK; queries answer with the value.
+        bool isQuery = inFlight.text.endsWith("?");
+        complete(reply, isQuery ? !reply.startsWith("E") : reply == "OK");
+        return;
+    }
 }
 
-QString PowerSupplyManager::querySetCurrent() {
-    sendCommand("PC?", true);
-    return readResponse();
+void PowerSupplyManager::handleTimeout() {
+    if (!busy)
+        return;
+    metrics.count(Metrics::Counter::SerialTimeouts);
+    // We no longer know which supply is listening, nor whether its reply is
+    // still on the way; hold the next command until the line is quiet.
+    selectedAddress.clear();
+    addressing = false;
+    resyncing = true;
+    resyncStartNs = Metrics::nowNs();
+    quietTimer.start(RESYNC_QUIET_MS);
+    complete("timeout", false);
+}
+
+void PowerSupplyManager::finishResync() {
+    resyncing = false;
+    rx.clear();
+    if (serial->isOpen())
+        serial->clear(QSerialPort::Input);
+    pump();
+}
+
+void PowerSupplyManager::complete(const QByteArray& reply, bool ok) {
+    busy = false;
+    Command done = inFlight;
+    if (!ok)
+        qDebug() << "PS" << done.address << done.text << "failed:" << reply;
+    emit commandFinished(done.id, done.address, done.text, reply, ok);
+    pump();
 }
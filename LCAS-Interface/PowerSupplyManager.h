@@ -2,46 +2,98 @@
 #define POWER_SUPPLY_MANAGER_H
 
 #include <QString>
+#include <QByteArray>
 #include <QSerialPort>
-#include <QSerialPortInfo>
 #include <QObject>
 #include <QTimer>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
+// Asynchronous driver for the Genesys-style supplies sharing one RS-485
+// line. Lives in its own thread (moveToThread, then invoke open()); every
+// public submit is thread-safe and returns at once with a command id, and
+// the outcome arrives through commandFinished().
+//
+// One command is on the wire at a time. The next one goes out as soon as
+// the reply's CR arrives, so spacing is set by the bus, not by sleeps.
+// ADR is only sent when the target differs from the selected supply, and
+// the selection is forgotten after any timeout. After a timeout the line is
+// left to go quiet and the input flushed before the next command, so a late
+// reply is never taken as the answer to it. Queued commands are served
+// strictly by priority; submitting a Safety command discards queued
+// setpoints (reported as failed), and setLockout() rejects setpoints and
+// output changes until it is cleared. submit() returns 0 when rejected.
 class PowerSupplyManager : public QObject {
     Q_OBJECT
 
 public:
+    enum class Priority { Safety, Control, Setpoint, Poll };
+    static constexpr int PRIORITY_COUNT = 4;
+    static constexpr int RESYNC_QUIET_MS = 100;     // silence needed after a timeout
+    static constexpr int RESYNC_MAX_MS = 1000;      // give up waiting for it after this
+
     explicit PowerSupplyManager(QObject* parent = nullptr);
     ~PowerSupplyManager();
 
-    bool connectToPort(const QString& portName, int baudRate = 9600);
-    void disconnect();
+    // Commands without the trailing CR, e.g. submit("06", "PV 12.50").
+    quint64 submit(const QString& address, const QByteArray& command, Priority priority);
 
-    bool setAddress(int address);
-    bool reset();
-    bool setRemoteMode();
+    quint64 setVoltage(const QString& address, double volts, Priority priority = Priority::Setpoint);
+    quint64 setCurrent(const QString& address, double amps, Priority priority = Priority::Setpoint);
+    quint64 enableOutput(const QString& address, bool on, Priority priority = Priority::Control);
+    quint64 queryVoltage(const QString& address, Priority priority = Priority::Poll);   // MV?
+    quint64 queryCurrent(const QString& address, Priority priority = Priority::Poll);   // MC?
 
-    bool setVoltage(double volts);
-    bool setCurrent(double amps);
-    bool enableOutput(bool on);
+    void setLockout(bool locked) { lockedOut.store(locked); }
+    bool isLockedOut() const { return lockedOut.load(); }
+    void setReplyTimeoutMs(int ms) { replyTimeoutMs = ms; }
 
-    QString queryVoltage();   // Actual output voltage
-    QString querySetVoltage(); // Programmed voltage
-    QString queryCurrent();   // Actual output current
-    QString querySetCurrent(); // Programmed current
+public slots:
+    bool open(const QString& portName, int baudRate = 9600);
+    void close();
 
 signals:
-    void responseReceived(const QString& response);
+    void commandFinished(quint64 id, const QString& address, const QByteArray& command,
+                         const QByteArray& reply, bool ok);
     void errorOccurred(const QString& error);
 
+private slots:
+    void pump();
+    void handleReadyRead();
+    void handleTimeout();
+    void finishResync();
+
 private:
+    struct Command {
+        quint64 id = 0;
+        QString address;
+        QByteArray text;
+    };
+
     QSerialPort* serial;
-    int currentAddress = 0;
+    QTimer timer;
+    QTimer quietTimer;
+    QByteArray rx;
+
+    std::mutex queueMutex;
+    std::deque<Command> queues[PRIORITY_COUNT];
+    std::atomic<quint64> nextId{1};
+    std::atomic<bool> lockedOut{false};
 
-    bool sendCommand(const QString& cmd, bool expectResponse = false);
-    QString readResponse();
+    // Owned by the driver thread.
+    bool busy = false;
+    bool addressing = false;    // the in-flight line is our ADR, not the command
+    Command inFlight;
+    qint64 sentNs = 0;          // when inFlight's first line went out
+    bool resyncing = false;     // discarding input after a timeout
+    qint64 resyncStartNs = 0;
+    QString selectedAddress;
+    int replyTimeoutMs = 250;
 
-    QString makeCommand(const QString& cmd) const;
+    bool takeNext(Command& out);
+    void sendLine(const QByteArray& line);
+    void complete(const QByteArray& reply, bool ok);
 };
 
 #endif // POWER_SUPPLY_MANAGER_H
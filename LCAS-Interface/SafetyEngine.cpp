@@ -0,0 +1,276 @@
+#include "SafetyEngine.h"
+#include "FlightRecorder.h"
+#include "Metrics.h"
+#include <pthread.h>
+#include <sched.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <QDebug>
+
+SafetyEngine::SafetyEngine(QObject* parent) : QObject(parent) {
+    for (auto& threshold : adcThreshold)
+        threshold.store(std::numeric_limits<double>::infinity());
+    for (auto& limit : adcDriftLimit)
+        limit.store(std::numeric_limits<double>::infinity());
+    for (auto& threshold : adcToneThreshold)
+        threshold.store(std::numeric_limits<double>::infinity());
+}
+
+SafetyEngine::~SafetyEngine() {
+    stop();
+}
+
+int64_t SafetyEngine::nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void SafetyEngine::setShutdownAction(ShutdownAction action) {
+    shutdownAction = std::move(action);
+}
+
+void SafetyEngine::setFlightRecorder(FlightRecorder* recorder) {
+    flightRecorder = recorder;
+}
+
+void SafetyEngine::setLatencyBudgetUs(int64_t budget) {
+    budgetUs = budget;
+}
+
+void SafetyEngine::setAdcFilter(const AdcFilterBank::Config& config) {
+    adcFilter.configure(config);
+}
+
+void SafetyEngine::setAdcTones(const AdcToneDetector::Config& config) {
+    adcTones.configure(config);
+}
+
+void SafetyEngine::setAdcThreshold(int channel, double value) {
+    if (channel >= 0 && channel < ADC_CHANNELS)
+        adcThreshold[channel].store(value);
+}
+
+void SafetyEngine::setAdcDriftLimit(int channel, double volts) {
+    if (channel >= 0 && channel < ADC_CHANNELS)
+        adcDriftLimit[channel].store(volts);
+}
+
+void SafetyEngine::setAdcToneThreshold(int channel, double voltsRms) {
+    if (channel >= 0 && channel < ADC_CHANNELS)
+        adcToneThreshold[channel].store(voltsRms);
+}
+
+void SafetyEngine::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+    running = true;
+    worker = std::thread(&SafetyEngine::run, this);
+}
+
+void SafetyEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        running = false;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void SafetyEngine::countOverrun(Metrics::Counter counter) {
+    metrics.count(counter);
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    ++stats.overruns;
+}
+
+void SafetyEngine::pushFrame(Sample&& sample) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frameQueue.full()) {
+            // Only reachable if the engine thread is starved. Lose the oldest
+            // frame that would not trip; if every one would, any of them
+            // still trips, so the oldest can go.
+            int victim = 0;
+            for (int i = 0; i < frameQueue.count; ++i) {
+                const ThermalFrame& frame = *frameQueue.at(i).frame;
+                if (!(frame.pecOk && frame.stats.exceeded())) {
+                    victim = i;
+                    break;
+                }
+            }
+            for (int i = victim; i > 0; --i)
+                frameQueue.at(i) = std::move(frameQueue.at(i - 1));
+            frameQueue.pop();
+            countOverrun(Metrics::Counter::FramesDropped);
+        }
+        frameQueue.push(std::move(sample));
+    }
+    wake.notify_one();
+}
+
+void SafetyEngine::pushAdc(Sample&& sample) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (adcQueue.full()) {
+            // Only reachable if the engine thread is starved for about a
+            // second. The tone detector restarts its blocks across the gap.
+            adcQueue.pop();
+            adcQueue.at(0).afterGap = true;
+            countOverrun(Metrics::Counter::AdcSamplesDropped);
+        }
+        adcQueue.push(std::move(sample));
+    }
+    wake.notify_one();
+}
+
+void SafetyEngine::submitThermal(const ThermalFramePtr& frame) {
+    if (!frame)
+        return;
+    Sample sample;
+    sample.frame = frame;
+    sample.timeUs = frame->timestampUs;
+    pushFrame(std::move(sample));
+}
+
+void SafetyEngine::submitAdc(const double* values, int n, int64_t timestampUs, unsigned fresh,
+                             const int64_t* channelTimeUs) {
+    Sample sample;
+    sample.adcCount = n < ADC_CHANNELS ? n : ADC_CHANNELS;
+    sample.adcFresh = fresh;
+    for (int i = 0; i < sample.adcCount; ++i) {
+        sample.adc[i] = values[i];
+        sample.adcTimeUs[i] = channelTimeUs ? channelTimeUs[i] : timestampUs;
+    }
+    sample.timeUs = timestampUs;
+    pushAdc(std::move(sample));
+}
+
+void SafetyEngine::run() {
+    sched_param param = {};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 40;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+        fprintf(stderr, "Safety engine: SCHED_FIFO unavailable (%s), using normal priority\n", strerror(err));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return !running || frameQueue.count > 0 || adcQueue.count > 0; });
+        if (!running)
+            return;
+
+        // Frames are few and each may be the only one from a hot camera.
+        Sample sample = frameQueue.count > 0 ? frameQueue.pop() : adcQueue.pop();
+
+        lock.unlock();
+        evaluate(sample);
+        lock.lock();
+    }
+}
+
+void SafetyEngine::evaluate(const Sample& sample) {
+    int64_t startNs = Metrics::nowNs();
+    QString reason;
+    if (sample.frame) {
+        // Frames that failed every PEC retry carry no usable temperatures.
+        const ThermalFrame& frame = *sample.frame;
+        if (frame.pecOk && frame.stats.exceeded())
+            reason = QString("Camera %1: %2 px over threshold, max %3 C at (%4, %5)")
+                         .arg(frame.camIndex).arg(frame.stats.overThreshold)
+                         .arg(frame.stats.max / 10.0, 0, 'f', 1)
+                         .arg(frame.stats.maxX).arg(frame.stats.maxY);
+    } else {
+        reason = evaluateAdc(sample);
+    }
+
+    metrics.record(Metrics::Stage::Evaluate, Metrics::nowNs() - startNs);
+
+    int64_t latencyUs = nowUs() - sample.timeUs;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.lastUs = latencyUs;
+        if (latencyUs > stats.maxUs) stats.maxUs = latencyUs;
+        ++stats.samples;
+        if (latencyUs > budgetUs) ++stats.overBudget;
+    }
+    if (latencyUs > budgetUs) {
+        // stats.overBudget and the evaluate histogram have every one; the
+        // log gets at most one line a second so it cannot slow the engine.
+        ++overBudgetUnlogged;
+        int64_t now = nowUs();
+        if (now - overBudgetLoggedUs >= OVER_BUDGET_LOG_US) {
+            qWarning() << overBudgetUnlogged << "safety samples over budget since the last report, latest"
+                       << latencyUs << "us after capture, budget" << budgetUs << "us";
+            overBudgetLoggedUs = now;
+            overBudgetUnlogged = 0;
+        }
+    }
+
+    if (!reason.isEmpty())
+        trip(reason, sample.timeUs);
+}
+
+QString SafetyEngine::evaluateAdc(const Sample& sample) {
+    if (sample.afterGap)
+        adcTones.restartBlocks();
+    // NaN never compares over a limit, so channels without data stay quiet.
+    if (adcFilter.push(sample.adc, sample.adcCount, sample.adcFresh, adcFiltered)) {
+        for (int i = 0; i < sample.adcCount; ++i) {
+            double threshold = adcThreshold[i].load();
+            double span = adcFiltered.max[i] - adcFiltered.min[i];
+            if (adcFiltered.value[i] > threshold)
+                return QString("ADC channel %1 exceeded threshold (%2 > %3)")
+                           .arg(i).arg(adcFiltered.value[i]).arg(threshold);
+            if (span > adcDriftLimit[i].load())
+                return QString("ADC channel %1 drifted %2 V within the filter window (mean %3, std %4)")
+                           .arg(i).arg(span).arg(adcFiltered.mean[i]).arg(adcFiltered.stddev[i]);
+        }
+    }
+
+    if (adcTones.push(sample.adc, sample.adcTimeUs, sample.adcCount, sample.adcFresh, adcTonePower)) {
+        const AdcToneDetector::Config& tones = adcTones.config();
+        for (int i = 0; i < sample.adcCount; ++i) {
+            if (!(adcTonePower.updated >> i & 1u))
+                continue;
+            double threshold = adcToneThreshold[i].load();
+            for (int k = 0; k < tones.tones; ++k)
+                if (adcTonePower.rms[i][k] > threshold)
+                    return QString("ADC channel %1: %2 Hz modulation at %3 V RMS (> %4)")
+                               .arg(i).arg(tones.toneHz[k]).arg(adcTonePower.rms[i][k]).arg(threshold);
+        }
+    }
+    return QString();
+}
+
+void SafetyEngine::trip(const QString& reason, int64_t sampleUs) {
+    if (trippedFlag.exchange(true))
+        return;
+    // The shutdown sequence closes this when every output is off.
+    metrics.beginEStop(sampleUs * 1000);
+
+    int64_t latencyUs = nowUs() - sampleUs;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.lastTripUs = latencyUs;
+    }
+    qWarning().noquote() << "TRIP:" << reason << "-" << latencyUs << "us from sample to shutdown"
+                         << (latencyUs > budgetUs ? "(OVER BUDGET)" : "");
+
+    if (shutdownAction)
+        shutdownAction(reason);
+    if (flightRecorder)
+        flightRecorder->trigger(reason.toStdString());
+    emit tripped(reason, latencyUs);
+}
+
+void SafetyEngine::reset() {
+    trippedFlag.store(false);
+}
+
+SafetyEngine::LatencyStats SafetyEngine::latency() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
@@ -0,0 +1,149 @@
+#ifndef SAFETY_ENGINE_H
+#define SAFETY_ENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ThermalFrame.h"
+#include "AdcFilterBank.h"
+#include "AdcToneDetector.h"
+#include "Metrics.h"
+
+class FlightRecorder;
+
+// Trip evaluation on a dedicated SCHED_FIFO thread. Camera workers and the
+// ADC reader hand samples straight to submitThermal()/submitAdc(); the engine
+// decides, latches the trip, freezes the flight recorder and runs the
+// shutdown action on its own thread, so nothing on the trip path waits for
+// the GUI event loop. The GUI only observes through tripped().
+//
+// Latency is measured from the sample's capture timestamp to the moment it
+// is evaluated (and, on a trip, to when the shutdown action is started) and
+// checked against a budget.
+//
+// ADC samples go through an AdcFilterBank first: thresholds are compared
+// against the despiked, decimated level, and an optional drift limit against
+// the span of the filter's statistics window, so a glitch does not trip and
+// a slow rise does. An AdcToneDetector alongside it trips on in-band power
+// at the laser's modulation frequencies, which ambient light does not carry.
+class SafetyEngine : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int ADC_CHANNELS = 4;
+
+    using ShutdownAction = std::function<void(const QString& reason)>;
+
+    struct LatencyStats {
+        int64_t lastUs = 0;
+        int64_t maxUs = 0;
+        int64_t lastTripUs = -1;    // sample-to-action for the last trip
+        uint64_t samples = 0;
+        uint64_t overBudget = 0;
+        uint64_t overruns = 0;      // samples lost because a queue was full
+    };
+
+    explicit SafetyEngine(QObject* parent = nullptr);
+    ~SafetyEngine();
+
+    // Configure before start(). The action runs on the engine thread.
+    void setShutdownAction(ShutdownAction action);
+    void setFlightRecorder(FlightRecorder* recorder);
+    void setLatencyBudgetUs(int64_t budgetUs);
+    void setAdcFilter(const AdcFilterBank::Config& config);
+    void setAdcTones(const AdcToneDetector::Config& config);
+
+    void start();
+    void stop();
+
+    // Safe from any thread; never block on evaluation.
+    void setAdcThreshold(int channel, double value);
+    void setAdcDriftLimit(int channel, double volts);   // max - min over the window
+    void setAdcToneThreshold(int channel, double voltsRms);
+    void submitThermal(const ThermalFramePtr& frame);
+    // `fresh` has a bit per channel converted since the last sample, and
+    // channelTimeUs (if given) each channel's conversion time.
+    void submitAdc(const double* values, int count, int64_t timestampUs, unsigned fresh = ~0u,
+                   const int64_t* channelTimeUs = nullptr);
+
+    bool isTripped() const { return trippedFlag.load(); }
+    void reset();
+
+    LatencyStats latency() const;
+    static int64_t nowUs();   // steady_clock, same base as ThermalFrame::timestampUs
+
+signals:
+    void tripped(const QString& reason, qint64 latencyUs);
+
+private:
+    struct Sample {
+        ThermalFramePtr frame;       // null for ADC samples
+        double adc[ADC_CHANNELS];
+        int adcCount = 0;
+        unsigned adcFresh = 0;
+        int64_t adcTimeUs[ADC_CHANNELS];
+        int64_t timeUs = 0;
+        bool afterGap = false;       // scans before this one were dropped
+    };
+
+    // Frames and ADC scans queue separately: a burst of scans must not push
+    // out a camera's only pending frame, and the ADC filters need every scan.
+    template <int N>
+    struct SampleQueue {
+        Sample items[N];
+        int head = 0;
+        int count = 0;
+
+        Sample& at(int i) { return items[(head + i) % N]; }
+        bool full() const { return count == N; }
+        void push(Sample&& sample) { items[(head + count++) % N] = std::move(sample); }
+        Sample pop() {
+            Sample sample = std::move(items[head]);
+            head = (head + 1) % N;
+            --count;
+            return sample;
+        }
+    };
+
+    static constexpr int FRAME_QUEUE_SIZE = 16;     // four cameras, a few frames each
+    static constexpr int ADC_QUEUE_SIZE = 1024;     // about a second of scans
+    static constexpr int64_t OVER_BUDGET_LOG_US = 1000000;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    SampleQueue<FRAME_QUEUE_SIZE> frameQueue;
+    SampleQueue<ADC_QUEUE_SIZE> adcQueue;
+    bool running = false;
+    std::thread worker;
+
+    ShutdownAction shutdownAction;
+    FlightRecorder* flightRecorder = nullptr;
+    int64_t budgetUs = 10000;
+    std::atomic<double> adcThreshold[ADC_CHANNELS];
+    std::atomic<double> adcDriftLimit[ADC_CHANNELS];
+    std::atomic<double> adcToneThreshold[ADC_CHANNELS];
+    AdcFilterBank adcFilter;     // engine thread only once started
+    AdcFilterBank::Output adcFiltered;
+    AdcToneDetector adcTones;
+    AdcToneDetector::Output adcTonePower;
+    std::atomic<bool> trippedFlag{false};
+
+    mutable std::mutex statsMutex;
+    LatencyStats stats;
+    int64_t overBudgetLoggedUs = 0;     // engine thread only
+    uint64_t overBudgetUnlogged = 0;
+
+    void pushFrame(Sample&& sample);
+    void pushAdc(Sample&& sample);
+    void countOverrun(Metrics::Counter counter);
+    void run();
+    void evaluate(const Sample& sample);
+    QString evaluateAdc(const Sample& sample);    // trip reason or empty
+    void trip(const QString& reason, int64_t sampleUs);
+};
+
+#endif // SAFETY_ENGINE_H
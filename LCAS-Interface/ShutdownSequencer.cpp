@@ -0,0 +1,142 @@
+#include "ShutdownSequencer.h"
+#include "PowerSupplyManager.h"
+#include "GpioLine.h"
+#include "Metrics.h"
+#include <QDebug>
+
+ShutdownSequencer::ShutdownSequencer(PowerSupplyManager* supplies, QObject* parent)
+    : QObject(parent), supplies(supplies) {
+    connect(supplies, &PowerSupplyManager::commandFinished, this, &ShutdownSequencer::handleCommandFinished);
+
+    // PS2 first, PS1 second, seed last.
+    addSupply("07", "PS2");
+    addSupply("06", "PS1");
+    plan.push_back({QString(), QByteArray(), Check::None, (int)plan.size(), "seed off"});
+}
+
+void ShutdownSequencer::addSupply(const QString& address, const QString& label) {
+    int first = (int)plan.size();
+    plan.push_back({address, "PC 0", Check::Ok, first, label + " PC 0"});
+    plan.push_back({address, "PV 0", Check::Ok, first, label + " PV 0"});
+    int out = (int)plan.size();
+    plan.push_back({address, "OUT 0", Check::Ok, first, label + " OUT 0"});
+    plan.push_back({address, "OUT?", Check::OutputOff, out, label + " OUT?"});
+    plan.push_back({address, "MV?", Check::VoltageLow, out, label + " MV?"});
+}
+
+void ShutdownSequencer::start() {
+    if (running.exchange(true))
+        return;
+    // Nothing but this sequence may drive the supplies until the trip is reset.
+    supplies->setLockout(true);
+    // A trip has already set the origin to its sample; a manual stop starts now.
+    metrics.beginEStop(Metrics::nowNs());
+    verified = true;
+    current = 0;
+    failures = 0;
+    log.clear();
+    clock.start();
+    qDebug() << "Emergency stop activated! Shutting down power supplies.";
+    sendCurrent();
+}
+
+void ShutdownSequencer::sendCurrent() {
+    if (current >= plan.size()) {
+        running.store(false);
+        metrics.endEStop();
+        qint64 total = elapsedUs();
+        qDebug().noquote() << report();
+        emit finished(verified, total);
+        return;
+    }
+
+    const Step& step = plan[current];
+    stepStartUs = elapsedUs();
+
+    if (step.address.isEmpty()) {
+        // SEED PS LAST
+        bool ok = seedLine && seedLine->set(1) && seedLine->get() == 1;
+        finishStep(ok, ok ? "OK" : !seedLine || !seedLine->isOpen() ? "gpio line not held" : "gpio readback failed");
+        return;
+    }
+
+    pendingId = supplies->submit(step.address, step.command, PowerSupplyManager::Priority::Safety);
+}
+
+void ShutdownSequencer::handleCommandFinished(quint64 id, const QString&, const QByteArray&,
+                                              const QByteArray& reply, bool) {
+    if (!running.load() || id != pendingId)
+        return;
+    pendingId = 0;
+    finishStep(accept(plan[current], reply), reply);
+}
+
+bool ShutdownSequencer::accept(const Step& step, const QByteArray& reply) const {
+    switch (step.check) {
+    case Check::Ok:
+        return reply == "OK";
+    case Check::OutputOff:
+        return reply == "OFF" || reply == "0";
+    case Check::VoltageLow: {
+        bool ok = false;
+        double volts = reply.toDouble(&ok);
+        return ok && volts <= voltageLimit;
+    }
+    case Check::None:
+        return true;
+    }
+    return false;
+}
+
+void ShutdownSequencer::finishStep(bool ok, const QByteArray& reply) {
+    const Step& step = plan[current];
+    StepRecord record;
+    record.name = step.name;
+    record.startUs = stepStartUs;
+    record.durationUs = elapsedUs() - stepStartUs;
+    record.attempts = failures + 1;
+    record.reply = reply;
+    record.ok = ok;
+    log.push_back(record);
+    emit stepFinished(step.name, ok, record.durationUs);
+
+    if (ok) {
+        ++current;
+        if (current >= plan.size() || plan[current].address != step.address)
+            failures = 0;
+        sendCurrent();
+        return;
+    }
+
+    if (++failures < maxAttempts) {
+        current = step.retryFrom;
+        sendCurrent();
+        return;
+    }
+
+    qWarning().noquote() << "Shutdown step" << step.name << "not verified after" << failures << "attempts";
+    verified = false;
+    skipSupply();
+}
+
+void ShutdownSequencer::skipSupply() {
+    // Give up on this supply and carry on with the next one (or the seed).
+    QString address = plan[current].address;
+    do {
+        ++current;
+    } while (current < plan.size() && !address.isEmpty() && plan[current].address == address);
+    failures = 0;
+    sendCurrent();
+}
+
+QString ShutdownSequencer::report() const {
+    QString text = QString("Shutdown %1:").arg(verified ? "verified" : "NOT verified");
+    for (const StepRecord& r : log)
+        text += QString("\n  %1 +%2 ms  %3 ms  %4  %5")
+                    .arg(r.name)
+                    .arg(r.startUs / 1000.0, 0, 'f', 1)
+                    .arg(r.durationUs / 1000.0, 0, 'f', 1)
+                    .arg(r.ok ? "ok" : "FAIL")
+                    .arg(QString::fromLatin1(r.reply));
+    return text;
+}
@@ -0,0 +1,97 @@
+#ifndef SHUTDOWN_SEQUENCER_H
+#define SHUTDOWN_SEQUENCER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+#include <vector>
+
+class PowerSupplyManager;
+class GpioLine;
+
+// Emergency shutdown as an event-driven state machine: PS2 (address 07),
+// then PS1 (06), then the seed supply. Each supply gets PC 0, PV 0 and
+// OUT 0 and is then read back with OUT? (must answer OFF) and MV? (must be
+// under voltageLimit). Commands go through PowerSupplyManager at Safety
+// priority, which handles ADR and reply framing, so each step takes as
+// long as the bus needs and no longer. A step that fails is retried; a
+// supply that never verifies is reported and the sequence moves on, so the
+// seed is always cut last but never skipped.
+//
+// Lives in the supply driver's thread. start() is safe to queue from any
+// thread. Each step's start, duration and reply are kept for the report.
+// The seed step drives the held seed-lock line and reads it back, so it
+// costs one ioctl pair rather than a bus round trip.
+class ShutdownSequencer : public QObject {
+    Q_OBJECT
+public:
+    struct StepRecord {
+        QString name;
+        qint64 startUs = 0;     // from start()
+        qint64 durationUs = 0;
+        int attempts = 0;       // including this one
+        QByteArray reply;
+        bool ok = false;
+    };
+
+    static constexpr const char* GPIO_CHIP = "/dev/gpiochip0";
+    static constexpr int SEED_LINE = 12;    // BCM; high locks the seed supply out
+
+    explicit ShutdownSequencer(PowerSupplyManager* supplies, QObject* parent = nullptr);
+
+    void setVoltageLimit(double volts) { voltageLimit = volts; }
+    void setSeedLine(GpioLine* line) { seedLine = line; }
+
+    bool isRunning() const { return running.load(); }
+    const std::vector<StepRecord>& records() const { return log; }
+    QString report() const;
+
+public slots:
+    void start();
+
+signals:
+    void stepFinished(const QString& name, bool ok, qint64 durationUs);
+    void finished(bool verified, qint64 totalUs);
+
+private slots:
+    void handleCommandFinished(quint64 id, const QString& address, const QByteArray& command,
+                               const QByteArray& reply, bool ok);
+
+private:
+    enum class Check { Ok, OutputOff, VoltageLow, None };
+
+    struct Step {
+        QString address;        // empty for the seed step
+        QByteArray command;
+        Check check;
+        int retryFrom;          // step index to go back to when the check fails
+        QString name;
+    };
+
+    PowerSupplyManager* supplies;
+    GpioLine* seedLine = nullptr;
+    QElapsedTimer clock;
+
+    std::vector<Step> plan;
+    std::vector<StepRecord> log;
+    size_t current = 0;
+    int failures = 0;           // failed attempts on the current supply
+    quint64 pendingId = 0;
+    qint64 stepStartUs = 0;
+    std::atomic<bool> running{false};
+    bool verified = true;
+
+    int maxAttempts = 3;
+    double voltageLimit = 1.0;
+
+    void addSupply(const QString& address, const QString& label);
+    void sendCurrent();
+    void finishStep(bool ok, const QByteArray& reply);
+    void skipSupply();
+    bool accept(const Step& step, const QByteArray& reply) const;
+    qint64 elapsedUs() const { return clock.nsecsElapsed() / 1000; }
+};
+
+#endif // SHUTDOWN_SEQUENCER_H
@@ -0,0 +1,157 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+#include <cstring>
+
+// Minimal portable 8 x int16 vector layer for the thermal frame kernels.
+// SSE2 on x86, NEON on the Pi, plain arrays elsewhere. Loads and stores are
+// unaligned and take untyped pointers so raw I2C buffers can be used directly.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LCAS_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LCAS_SIMD_NEON 1
+#endif
+
+namespace simd {
+
+constexpr int I16_LANES = 8;
+
+#if defined(LCAS_SIMD_SSE2)
+
+using i16x8 = __m128i;
+
+inline i16x8 load(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+inline void store(void* p, i16x8 v) { _mm_storeu_si128((__m128i*)p, v); }
+inline i16x8 splat(int16_t x) { return _mm_set1_epi16(x); }
+inline i16x8 max(i16x8 a, i16x8 b) { return _mm_max_epi16(a, b); }
+inline i16x8 min(i16x8 a, i16x8 b) { return _mm_min_epi16(a, b); }
+inline i16x8 cmpgt(i16x8 a, i16x8 b) { return _mm_cmpgt_epi16(a, b); }
+inline bool any(i16x8 mask) { return _mm_movemask_epi8(mask) != 0; }
+inline i16x8 add(i16x8 a, i16x8 b) { return _mm_add_epi16(a, b); }
+inline i16x8 sub(i16x8 a, i16x8 b) { return _mm_sub_epi16(a, b); }
+inline i16x8 mullo(i16x8 a, i16x8 b) { return _mm_mullo_epi16(a, b); }
+inline i16x8 sra(i16x8 a, int n) { return _mm_srai_epi16(a, n); }
+inline i16x8 select(i16x8 mask, i16x8 a, i16x8 b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+inline i16x8 iota() { return _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7); }
+
+using i32x4 = __m128i;
+
+inline i32x4 zero32() { return _mm_setzero_si128(); }
+// Widen adjacent int16 pairs and add them into the four int32 lanes.
+inline i32x4 addPairs(i32x4 acc, i16x8 v) { return _mm_add_epi32(acc, _mm_madd_epi16(v, _mm_set1_epi16(1))); }
+inline int32_t hsum(i32x4 v) {
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#elif defined(LCAS_SIMD_NEON)
+
+using i16x8 = int16x8_t;
+
+inline i16x8 load(const void* p) { return vreinterpretq_s16_u8(vld1q_u8((const uint8_t*)p)); }
+inline void store(void* p, i16x8 v) { vst1q_u8((uint8_t*)p, vreinterpretq_u8_s16(v)); }
+inline i16x8 splat(int16_t x) { return vdupq_n_s16(x); }
+inline i16x8 max(i16x8 a, i16x8 b) { return vmaxq_s16(a, b); }
+inline i16x8 min(i16x8 a, i16x8 b) { return vminq_s16(a, b); }
+inline i16x8 cmpgt(i16x8 a, i16x8 b) { return vreinterpretq_s16_u16(vcgtq_s16(a, b)); }
+inline bool any(i16x8 mask) {
+    uint64x2_t m = vreinterpretq_u64_s16(mask);
+    return (vgetq_lane_u64(m, 0) | vgetq_lane_u64(m, 1)) != 0;
+}
+inline i16x8 add(i16x8 a, i16x8 b) { return vaddq_s16(a, b); }
+inline i16x8 sub(i16x8 a, i16x8 b) { return vsubq_s16(a, b); }
+inline i16x8 mullo(i16x8 a, i16x8 b) { return vmulq_s16(a, b); }
+inline i16x8 sra(i16x8 a, int n) { return vshlq_s16(a, vdupq_n_s16((int16_t)-n)); }
+inline i16x8 select(i16x8 mask, i16x8 a, i16x8 b) { return vbslq_s16(vreinterpretq_u16_s16(mask), a, b); }
+inline i16x8 iota() {
+    static const int16_t lanes[I16_LANES] = {0, 1, 2, 3, 4, 5, 6, 7};
+    return vld1q_s16(lanes);
+}
+
+using i32x4 = int32x4_t;
+
+inline i32x4 zero32() { return vdupq_n_s32(0); }
+inline i32x4 addPairs(i32x4 acc, i16x8 v) { return vpadalq_s16(acc, v); }
+inline int32_t hsum(i32x4 v) {
+    int32x2_t pair = vadd_s32(vget_low_s32(v), vget_high_s32(v));
+    return vget_lane_s32(vpadd_s32(pair, pair), 0);
+}
+
+#else
+
+struct i16x8 { int16_t v[I16_LANES]; };
+
+inline i16x8 load(const void* p) { i16x8 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void store(void* p, i16x8 v) { memcpy(p, v.v, sizeof(v.v)); }
+inline i16x8 splat(int16_t x) { i16x8 r; for (auto& e : r.v) e = x; return r; }
+inline i16x8 max(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    return a;
+}
+inline i16x8 min(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    return a;
+}
+inline i16x8 cmpgt(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = a.v[i] > b.v[i] ? -1 : 0;
+    return a;
+}
+inline bool any(i16x8 mask) {
+    for (int i = 0; i < I16_LANES; ++i) if (mask.v[i]) return true;
+    return false;
+}
+inline i16x8 add(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = (int16_t)(a.v[i] + b.v[i]);
+    return a;
+}
+inline i16x8 sub(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = (int16_t)(a.v[i] - b.v[i]);
+    return a;
+}
+inline i16x8 mullo(i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = (int16_t)(a.v[i] * b.v[i]);
+    return a;
+}
+inline i16x8 sra(i16x8 a, int n) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = (int16_t)(a.v[i] >> n);
+    return a;
+}
+inline i16x8 select(i16x8 mask, i16x8 a, i16x8 b) {
+    for (int i = 0; i < I16_LANES; ++i) a.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    return a;
+}
+inline i16x8 iota() { i16x8 r; for (int i = 0; i < I16_LANES; ++i) r.v[i] = (int16_t)i; return r; }
+
+struct i32x4 { int32_t v[4]; };
+
+inline i32x4 zero32() { return i32x4{}; }
+inline i32x4 addPairs(i32x4 acc, i16x8 v) {
+    for (int i = 0; i < I16_LANES; ++i) acc.v[i / 2] += v.v[i];
+    return acc;
+}
+inline int32_t hsum(i32x4 v) { return v.v[0] + v.v[1] + v.v[2] + v.v[3]; }
+
+#endif
+
+// Little-endian int16 words to native int16. On little-endian hosts this is
+// a straight vector copy; big-endian hosts swap bytes in the scalar loop.
+inline void decodeLE16(const uint8_t* src, int16_t* dst, int n) {
+    int i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + I16_LANES <= n; i += I16_LANES)
+        store(dst + i, load(src + 2 * i));
+#endif
+    for (const uint8_t* p = src + 2 * i; i < n; ++i, p += 2)
+        dst[i] = (int16_t)((p[1] << 8) | p[0]);
+}
+
+} // namespace simd
+
+#endif // SIMD_H
@@ -0,0 +1,256 @@
+#include "SimulatedAds1263.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+SimulatedAds1263::SimulatedAds1263() : SimulatedAds1263(Options()) {}
+
+SimulatedAds1263::SimulatedAds1263(const Options& options)
+    : opts(options), rng(options.seed * 2654435761u + 1) {
+    for (int i = 0; i < CHANNELS; ++i)
+        inputs[i].store(opts.volts[i]);
+    reset();
+}
+
+void SimulatedAds1263::setInputVolts(int channel, double volts) {
+    if (channel >= 0 && channel < CHANNELS)
+        inputs[channel].store(volts, std::memory_order_relaxed);
+}
+
+bool SimulatedAds1263::open() {
+    reset();
+    return true;
+}
+
+void SimulatedAds1263::reset() {
+    // Power-on register defaults that matter here; ID reads as an ADS1263.
+    memset(regs, 0, sizeof(regs));
+    regs[Ads1263::REG_ID] = 0x23;
+    regs[Ads1263::REG_POWER] = 0x11;
+    regs[Ads1263::REG_INTERFACE] = 0x05;
+    regs[Ads1263::REG_MODE1] = 0x80;
+    regs[Ads1263::REG_MODE2] = 0x04;
+    regs[Ads1263::REG_INPMUX] = 0x01;
+    regs[Ads1263::REG_ADC2MUX] = 0x01;
+    adc1Running = false;
+    adc2Running = false;
+    newData1 = false;
+    newData2 = false;
+    lastReadyUs = -1;
+    consumedUs = nowUs();
+}
+
+int64_t SimulatedAds1263::nowUs() const {
+    if (!opts.realTime)
+        return clockUs;
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SimulatedAds1263::restart1(int64_t now) {
+    uint8_t drate = regs[Ads1263::REG_MODE2] & 0x0F;
+    int64_t period = (int64_t)(1e6 / Ads1263::dataRateHz(drate));
+    nextReadyUs = now + Ads1263::delayUs(regs[Ads1263::REG_MODE0]) +
+                  period * Ads1263::settlingPeriods(regs[Ads1263::REG_MODE1]);
+    newData1 = false;
+}
+
+void SimulatedAds1263::restart2(int64_t now) {
+    uint8_t drate = regs[Ads1263::REG_ADC2CFG] >> 6;
+    nextReady2Us = now + (int64_t)(1e6 / Ads1263::adc2RateHz(drate)) * Ads1263::ADC2_SETTLING_PERIODS;
+    newData2 = false;
+}
+
+void SimulatedAds1263::advance2(int64_t now) {
+    if (!adc2Running || nextReady2Us > now)
+        return;
+    uint8_t drate = regs[Ads1263::REG_ADC2CFG] >> 6;
+    int64_t period = (int64_t)(1e6 / Ads1263::adc2RateHz(drate));
+    int64_t last = nextReady2Us + (now - nextReady2Us) / period * period;
+    nextReady2Us = last + period;
+    data2 = convert(regs[Ads1263::REG_ADC2MUX], Ads1263::adc2NoiseUv(drate), last) & ~0xFF;
+    newData2 = true;
+}
+
+uint8_t SimulatedAds1263::statusByte() const {
+    return (newData1 ? Ads1263::STATUS_ADC1_NEW : 0) | (newData2 ? Ads1263::STATUS_ADC2_NEW : 0);
+}
+
+void SimulatedAds1263::advance(int64_t now) {
+    if (!adc1Running || nextReadyUs > now)
+        return;
+    int64_t period = (int64_t)(1e6 / Ads1263::dataRateHz(regs[Ads1263::REG_MODE2] & 0x0F));
+    // Only the newest result is readable; skip straight to it.
+    int64_t missed = (now - nextReadyUs) / period;
+    lastReadyUs = nextReadyUs + missed * period;
+    nextReadyUs = lastReadyUs + period;
+    data1 = convert(regs[Ads1263::REG_INPMUX],
+                    Ads1263::noiseUv(regs[Ads1263::REG_MODE2] & 0x0F, regs[Ads1263::REG_MODE1]), lastReadyUs);
+    newData1 = true;
+    conversionCount += missed + 1;
+}
+
+double SimulatedAds1263::gaussian() {
+    // Irwin-Hall: four uniforms give a close enough bell for noise.
+    double sum = 0;
+    for (int i = 0; i < 4; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        sum += (rng >> 8) * (1.0 / 16777216.0);
+    }
+    return (sum - 2.0) * 1.7320508;
+}
+
+int32_t SimulatedAds1263::convert(uint8_t mux, double noiseUv, int64_t timeUs) {
+    int p = mux >> 4, n = mux & 0x0F;
+    double volts = 0.0;
+    if (p % 2 == 0 && n == p + 1 && p / 2 < CHANNELS)
+        volts = inputs[p / 2].load(std::memory_order_relaxed);
+    double chipNoise = noiseUv * 1e-6;
+    volts += std::sqrt(chipNoise * chipNoise + opts.noiseVolts * opts.noiseVolts) * gaussian();
+    if (opts.toneVolts != 0.0)
+        volts += opts.toneVolts * std::sin(2.0 * M_PI * opts.toneHz * timeUs * 1e-6);
+
+    double code = std::round(volts / Ads1263::REF_VOLTS * 2147483648.0);
+    if (code > 2147483647.0) code = 2147483647.0;
+    if (code < -2147483648.0) code = -2147483648.0;
+    return (int32_t)code;
+}
+
+int SimulatedAds1263::execute(const uint8_t* tx, uint8_t* rx, int len) {
+    int64_t now = nowUs();
+    int i = 0;
+    while (i < len) {
+        uint8_t cmd = tx[i];
+        rx[i++] = 0;
+
+        if (cmd == Ads1263::CMD_RESET) {
+            reset();
+        } else if (cmd == Ads1263::CMD_START1) {
+            adc1Running = true;
+            restart1(now);
+        } else if (cmd == Ads1263::CMD_STOP1) {
+            adc1Running = false;
+        } else if (cmd == Ads1263::CMD_START2) {
+            adc2Running = true;
+            restart2(now);
+        } else if (cmd == Ads1263::CMD_STOP2) {
+            adc2Running = false;
+        } else if (cmd == Ads1263::CMD_RDATA2) {
+            advance(now);
+            advance2(now);
+            uint8_t out[6];
+            out[0] = statusByte();
+            out[1] = (uint8_t)(data2 >> 24);
+            out[2] = (uint8_t)(data2 >> 16);
+            out[3] = (uint8_t)(data2 >> 8);
+            out[4] = 0;
+            out[5] = Ads1263::checksum(out + 1, 3);
+            newData2 = false;
+            for (int k = 0; k < 6 && i < len; ++k)
+                rx[i++] = out[k];
+        } else if (cmd == Ads1263::CMD_RDATA1) {
+            advance(now);
+            advance2(now);
+            uint8_t out[6];
+            out[0] = statusByte();
+            out[1] = (uint8_t)(data1 >> 24);
+            out[2] = (uint8_t)(data1 >> 16);
+            out[3] = (uint8_t)(data1 >> 8);
+            out[4] = (uint8_t)data1;
+            out[5] = Ads1263::checksum(out + 1, 4);
+            uint64_t interval = opts.checksumFaultInterval > 0 ? (uint64_t)opts.checksumFaultInterval : 0;
+            if (newData1 && interval && ++reads1 % interval == 0)
+                out[5] ^= 0x5A;
+            newData1 = false;
+            for (int k = 0; k < 6 && i < len; ++k)
+                rx[i++] = out[k];
+        } else if ((cmd & 0xE0) == Ads1263::CMD_RREG || (cmd & 0xE0) == Ads1263::CMD_WREG) {
+            if (i >= len)
+                break;
+            int reg = cmd & 0x1F;
+            int n = (tx[i] & 0x1F) + 1;
+            rx[i++] = 0;
+            bool write = (cmd & 0xE0) == Ads1263::CMD_WREG;
+            bool restart = false, restart2nd = false;
+            for (int k = 0; k < n && i < len; ++k, ++i) {
+                int r = reg + k;
+                if (r >= Ads1263::NUM_REGS) {
+                    rx[i] = 0;
+                    continue;
+                }
+                if (write) {
+                    regs[r] = tx[i];
+                    rx[i] = 0;
+                    // Writes to the conversion setup restart ADC1.
+                    restart |= (r >= Ads1263::REG_MODE0 && r <= Ads1263::REG_INPMUX) ||
+                               r == Ads1263::REG_REFMUX;
+                    restart2nd |= r == Ads1263::REG_ADC2CFG || r == Ads1263::REG_ADC2MUX;
+                } else {
+                    rx[i] = regs[r];
+                }
+            }
+            if (restart && adc1Running)
+                restart1(now);
+            if (restart2nd && adc2Running)
+                restart2(now);
+        }
+    }
+    return 0;
+}
+
+int SimulatedAds1263::transfer(const SpiTransfer* xfers, int count) {
+    // Commands may span segments, so run the frame as one byte stream.
+    uint8_t tx[MAX_FRAME] = {}, rx[MAX_FRAME] = {};
+    int len = 0;
+    for (int i = 0; i < count; ++i) {
+        if (len + (int)xfers[i].len > MAX_FRAME)
+            return -1;
+        if (xfers[i].tx)
+            memcpy(tx + len, xfers[i].tx, xfers[i].len);
+        else
+            memset(tx + len, 0, xfers[i].len);
+        len += xfers[i].len;
+    }
+
+    execute(tx, rx, len);
+    if (!opts.realTime)
+        clockUs += len * US_PER_BYTE;
+
+    for (int i = 0, off = 0; i < count; off += xfers[i].len, ++i)
+        if (xfers[i].rx)
+            memcpy(xfers[i].rx, rx + off, xfers[i].len);
+    return 0;
+}
+
+void SimulatedAds1263::clearDataReady() {
+    consumedUs = nowUs();
+}
+
+int SimulatedAds1263::waitDataReady(int timeoutMs, int64_t* timestampUs) {
+    int64_t now = nowUs();
+    advance(now);
+
+    // An edge since the last one handed out is returned at once.
+    int64_t edge = lastReadyUs > consumedUs ? lastReadyUs : nextReadyUs;
+    int64_t deadline = now + (int64_t)timeoutMs * 1000;
+    if (!adc1Running || edge > deadline) {
+        if (opts.realTime)
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        else
+            clockUs = deadline;
+        return 0;
+    }
+
+    if (edge > now) {
+        if (opts.realTime)
+            std::this_thread::sleep_for(std::chrono::microseconds(edge - now));
+        else
+            clockUs = edge;
+        advance(edge);
+    }
+    consumedUs = edge;
+    if (timestampUs)
+        *timestampUs = edge;
+    return 1;
+}
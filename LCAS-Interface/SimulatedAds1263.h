@@ -0,0 +1,89 @@
+#ifndef SIMULATED_ADS1263_H
+#define SIMULATED_ADS1263_H
+
+#include <atomic>
+#include <cstdint>
+#include "SpiDevice.h"
+#include "Ads1263.h"
+
+// Hardware-free ADS1263 behind the SpiDevice interface. It decodes the
+// command stream (RESET, START/STOP, RREG/WREG, RDATA1/2) against a register
+// file and produces conversions on the schedule the chip would: a mux or
+// configuration write restarts the conversion, the first result lands after
+// the programmed delay plus the filter's settling periods, and later ones
+// follow at the data rate. ADC2 runs the same way on its own mux and rate
+// and, as on the chip, only signals through the status byte. Each
+// differential input carries a DC level plus
+// Gaussian noise (Ads1263::noiseUv for the configured rate and filter) and
+// an optional tone.
+//
+// In real time, waitDataReady() sleeps until the next conversion. Without
+// it the device runs on a virtual clock that jumps to each conversion and
+// charges 4 us per SPI byte (2 MHz), so the acquisition path can be run
+// flat out while rates still come out as on hardware.
+class SimulatedAds1263 : public SpiDevice {
+public:
+    static constexpr int CHANNELS = Ads1263::DIFF_CHANNELS;
+
+    struct Options {
+        double volts[CHANNELS] = {0.20, 0.35, 0.50, 0.65, 0.80};
+        double noiseVolts = 0.0;        // RMS, on top of the chip's own noise
+        double toneVolts = 0.0;         // amplitude on every input
+        double toneHz = 0.0;
+        bool realTime = true;
+        int checksumFaultInterval = 0;  // corrupt every Nth RDATA1, 0 = never
+        uint32_t seed = 1;
+    };
+
+    SimulatedAds1263();
+    explicit SimulatedAds1263(const Options& options);
+
+    // Safe from any thread while the device is in use.
+    void setInputVolts(int channel, double volts);
+
+    bool open() override;
+    void close() override {}
+    int transfer(const SpiTransfer* xfers, int count) override;
+    void clearDataReady() override;
+    int waitDataReady(int timeoutMs, int64_t* timestampUs) override;
+    void reset() override;
+    const char* name() const override { return "simulated"; }
+
+    uint64_t conversions() const { return conversionCount; }
+
+private:
+    static constexpr int MAX_FRAME = 64;
+    static constexpr int US_PER_BYTE = 4;
+
+    Options opts;
+    std::atomic<double> inputs[CHANNELS];
+    uint8_t regs[Ads1263::NUM_REGS] = {};
+    uint32_t rng;
+
+    bool adc1Running = false;
+    int64_t clockUs = 0;        // virtual clock when !realTime
+    int64_t nextReadyUs = 0;    // completion time of the conversion in progress
+    int64_t lastReadyUs = -1;   // last completed conversion
+    int64_t consumedUs = -1;    // last DRDY edge handed out or cleared
+    bool newData1 = false;
+    int32_t data1 = 0;
+    uint64_t conversionCount = 0;
+    uint64_t reads1 = 0;
+
+    bool adc2Running = false;
+    int64_t nextReady2Us = 0;
+    bool newData2 = false;
+    int32_t data2 = 0;          // 24-bit result in the top bytes
+
+    int64_t nowUs() const;
+    void restart1(int64_t now);
+    void restart2(int64_t now);
+    void advance(int64_t now);
+    void advance2(int64_t now);
+    uint8_t statusByte() const;
+    int32_t convert(uint8_t mux, double noiseUv, int64_t timeUs);
+    double gaussian();
+    int execute(const uint8_t* tx, uint8_t* rx, int len);
+};
+
+#endif // SIMULATED_ADS1263_H
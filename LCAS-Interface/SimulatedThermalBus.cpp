@@ -0,0 +1,113 @@
+#include "SimulatedThermalBus.h"
+#include "ThermalCameraManager.h"
+#include "D6TProtocol.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+SimulatedThermalBus::SimulatedThermalBus() : SimulatedThermalBus(Options()) {}
+
+SimulatedThermalBus::SimulatedThermalBus(const Options& options) : opts(options) {
+    for (int cam = 0; cam < MAX_CAMERAS; ++cam)
+        rngState[cam] = opts.seed * 2654435761u + cam + 1;
+}
+
+bool SimulatedThermalBus::loadReplay(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror("open thermal replay"); return false; }
+
+    constexpr int N_READ = ThermalCameraManager::N_READ;
+    uint8_t record[1 + N_READ];
+    while (fread(record, 1, sizeof(record), f) == sizeof(record)) {
+        int cam = record[0] % MAX_CAMERAS;
+        replay[cam].insert(replay[cam].end(), record + 1, record + 1 + N_READ);
+        replayAll.insert(replayAll.end(), record + 1, record + 1 + N_READ);
+    }
+    fclose(f);
+
+    if (replayAll.empty()) {
+        fprintf(stderr, "Thermal replay %s holds no complete frames\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool SimulatedThermalBus::open(int numCameras) {
+    for (int cam = 0; cam < MAX_CAMERAS; ++cam) {
+        frameCount[cam] = 0;
+        replayPos[cam] = 0;
+    }
+    return true;
+}
+
+int SimulatedThermalBus::readFrame(int camIndex, uint8_t* buf, int len) {
+    if (camIndex < 0 || camIndex >= MAX_CAMERAS || len != ThermalCameraManager::N_READ)
+        return -1;
+
+    uint64_t n = frameCount[camIndex]++;
+    if (replayAll.empty())
+        synthesize(camIndex, buf);
+    else
+        replayFrame(camIndex, buf);
+
+    uint64_t interval = opts.pecFaultInterval > 0 ? (uint64_t)opts.pecFaultInterval : 0;
+    if (interval && n % interval == interval - 1)
+        buf[2 + (n % ThermalCameraManager::N_PIXEL) * 2] ^= 0x5A;
+    return 0;
+}
+
+int SimulatedThermalBus::replayFrame(int camIndex, uint8_t* buf) {
+    constexpr int N_READ = ThermalCameraManager::N_READ;
+    const std::vector<uint8_t>& src = replay[camIndex].empty() ? replayAll : replay[camIndex];
+    size_t& pos = replayPos[camIndex];
+    if (pos + N_READ > src.size())
+        pos = 0;
+    memcpy(buf, src.data() + pos, N_READ);
+    pos += N_READ;
+    return 0;
+}
+
+void SimulatedThermalBus::synthesize(int camIndex, uint8_t* buf) {
+    constexpr int N_ROW = ThermalCameraManager::N_ROW;
+    constexpr int N_READ = ThermalCameraManager::N_READ;
+
+    // Hot spot position orbits the frame; each camera runs a quarter turn
+    // ahead of the previous one so the views differ.
+    double t = (double)frameCount[camIndex];
+    int sweep = opts.sweepFrames > 1 ? opts.sweepFrames : 2;
+    double phase = std::fmod(t, (double)sweep) / sweep;
+    double rise = phase < 0.5 ? phase * 2.0 : (1.0 - phase) * 2.0;
+    double peak = opts.hotSpotPeak - opts.ambient;
+    double angle = 2.0 * M_PI * (t / (4.0 * sweep) + camIndex * 0.25);
+    double cx = (N_ROW - 1) * 0.5 + N_ROW * 0.3 * std::cos(angle);
+    double cy = (N_ROW - 1) * 0.5 + N_ROW * 0.3 * std::sin(angle);
+
+    // The Gaussian is separable: N_ROW exps per axis instead of one per pixel.
+    double inv2s2 = 1.0 / (2.0 * opts.hotSpotSigma * opts.hotSpotSigma);
+    float gx[N_ROW], gy[N_ROW];
+    for (int i = 0; i < N_ROW; ++i) {
+        gx[i] = (float)std::exp(-(i - cx) * (i - cx) * inv2s2);
+        gy[i] = (float)std::exp(-(i - cy) * (i - cy) * inv2s2);
+    }
+
+    float base = (float)(opts.ambient * 10.0);
+    float amp = (float)(peak * rise * 10.0);
+    uint32_t& rng = rngState[camIndex];
+
+    int16_t ptat = (int16_t)std::lround(opts.ambient * 10.0 + 30.0);
+    buf[0] = (uint8_t)(ptat & 0xFF);
+    buf[1] = (uint8_t)((ptat >> 8) & 0xFF);
+
+    uint8_t* out = buf + 2;
+    for (int y = 0; y < N_ROW; ++y) {
+        for (int x = 0; x < N_ROW; ++x) {
+            rng = rng * 1664525u + 1013904223u;
+            int noise = (int)(rng >> 30) - 2;   // -2..+1 deci-degrees
+            int16_t v = (int16_t)(base + amp * gx[x] * gy[y] + noise);
+            *out++ = (uint8_t)(v & 0xFF);
+            *out++ = (uint8_t)((v >> 8) & 0xFF);
+        }
+    }
+
+    buf[N_READ - 1] = D6T_calcPEC(ThermalCameraManager::D6T_ADDR, buf, N_READ - 1);
+}
@@ -0,0 +1,52 @@
+#ifndef SIMULATED_THERMAL_BUS_H
+#define SIMULATED_THERMAL_BUS_H
+
+#include <cstdint>
+#include <vector>
+#include "ThermalBus.h"
+
+// Hardware-free ThermalBus. Without a replay file it synthesizes valid
+// D6T-32L responses (PTAT, pixels, correct PEC) with one Gaussian hot spot
+// per camera that orbits the field of view and sweeps between ambient and a
+// configurable peak. With loadReplay() it plays back raw responses captured
+// by RecordingThermalBus. Reads never sleep, so the pipeline runs as fast as
+// the consumer pulls frames.
+class SimulatedThermalBus : public ThermalBus {
+public:
+    static constexpr int MAX_CAMERAS = 4;
+
+    struct Options {
+        double ambient = 24.0;        // degC
+        double hotSpotPeak = 45.0;    // degC at the top of the sweep
+        double hotSpotSigma = 2.5;    // pixels
+        int sweepFrames = 200;        // frames per ambient -> peak -> ambient cycle
+        int pecFaultInterval = 0;     // corrupt every Nth read, 0 = never
+        uint32_t seed = 1;
+    };
+
+    SimulatedThermalBus();
+    explicit SimulatedThermalBus(const Options& options);
+
+    // Replay raw frames instead of synthesizing. Returns false if the file
+    // cannot be read or holds no complete record.
+    bool loadReplay(const char* path);
+
+    bool open(int numCameras) override;
+    int readFrame(int camIndex, uint8_t* buf, int len) override;
+    bool independentCameras() const override { return true; }
+    const char* name() const override { return "simulated"; }
+
+private:
+    Options opts;
+    uint64_t frameCount[MAX_CAMERAS] = {};
+    uint32_t rngState[MAX_CAMERAS] = {};
+
+    std::vector<uint8_t> replay[MAX_CAMERAS];
+    std::vector<uint8_t> replayAll;
+    size_t replayPos[MAX_CAMERAS] = {};
+
+    void synthesize(int camIndex, uint8_t* buf);
+    int replayFrame(int camIndex, uint8_t* buf);
+};
+
+#endif // SIMULATED_THERMAL_BUS_H
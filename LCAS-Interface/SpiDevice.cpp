@@ -0,0 +1,98 @@
+#include "SpiDevice.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <cstdio>
+#include <ctime>
+
+static void delay(int ms) {
+    timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000};
+    nanosleep(&ts, nullptr);
+}
+
+LinuxSpiDevice::LinuxSpiDevice(const char* spiPath, const char* chipPath)
+    : spiPath(spiPath), chipPath(chipPath) {}
+
+LinuxSpiDevice::~LinuxSpiDevice() {
+    close();
+}
+
+bool LinuxSpiDevice::open() {
+    close();
+
+    spiFd = ::open(spiPath, O_RDWR);
+    if (spiFd < 0) { perror("open spidev"); return false; }
+
+    uint8_t mode = SPI_MODE_1;
+    uint8_t bits = 8;
+    uint32_t speed = SPEED_HZ;
+    if (ioctl(spiFd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(spiFd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(spiFd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        perror("ioctl spidev setup");
+        close();
+        return false;
+    }
+
+    if (!cs.requestOutput(chipPath, CS_LINE, 1, "ads1263_cs") ||
+        !rst.requestOutput(chipPath, RST_LINE, 1, "ads1263_rst") ||
+        !drdy.requestInput(chipPath, DRDY_LINE, GpioLine::Edge::Falling, "ads1263_drdy")) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LinuxSpiDevice::close() {
+    if (spiFd >= 0)
+        ::close(spiFd);
+    spiFd = -1;
+    cs.close();
+    rst.close();
+    drdy.close();
+}
+
+int LinuxSpiDevice::transfer(const SpiTransfer* xfers, int count) {
+    if (spiFd < 0 || count < 1 || count > MAX_XFERS)
+        return -1;
+
+    // Every segment goes to the kernel in one SPI_IOC_MESSAGE, so a
+    // multi-command frame costs one syscall.
+    struct spi_ioc_transfer msg[MAX_XFERS] = {};
+    for (int i = 0; i < count; ++i) {
+        msg[i].tx_buf = (uintptr_t)xfers[i].tx;
+        msg[i].rx_buf = (uintptr_t)xfers[i].rx;
+        msg[i].len = xfers[i].len;
+        msg[i].speed_hz = SPEED_HZ;
+        msg[i].bits_per_word = 8;
+    }
+
+    cs.set(0);
+    int res = ioctl(spiFd, SPI_IOC_MESSAGE(count), msg);
+    cs.set(1);
+    if (res < 0) {
+        perror("ioctl SPI_IOC_MESSAGE");
+        return -1;
+    }
+    return 0;
+}
+
+void LinuxSpiDevice::clearDataReady() {
+    drdy.drainEdges();
+}
+
+int LinuxSpiDevice::waitDataReady(int timeoutMs, int64_t* timestampUs) {
+    return drdy.waitEdge(timeoutMs, timestampUs);
+}
+
+void LinuxSpiDevice::reset() {
+    if (!rst.isOpen())
+        return;
+    rst.set(1);
+    delay(200);
+    rst.set(0);
+    delay(200);
+    rst.set(1);
+    delay(200);
+}
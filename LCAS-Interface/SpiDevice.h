@@ -0,0 +1,77 @@
+#ifndef SPI_DEVICE_H
+#define SPI_DEVICE_H
+
+#include <cstdint>
+#include "GpioLine.h"
+
+// One segment of a chip-select frame. rx may be null when the reply is not
+// needed; tx may be null to clock out zeros.
+struct SpiTransfer {
+    const uint8_t* tx = nullptr;
+    uint8_t* rx = nullptr;
+    uint32_t len = 0;
+};
+
+// An SPI peripheral with a data-ready line and a hardware reset, as the
+// ADS1263 is wired on the stray-light board. Implemented by LinuxSpiDevice
+// (spidev + gpiochip) and SimulatedAds1263, so the driver and the
+// acquisition thread run unchanged without hardware.
+class SpiDevice {
+public:
+    virtual ~SpiDevice() = default;
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+
+    // Runs every segment inside one chip-select frame. Returns 0 or -1.
+    virtual int transfer(const SpiTransfer* xfers, int count) = 0;
+
+    // Drops data-ready edges that happened before now, e.g. after a mux
+    // change restarted the conversion.
+    virtual void clearDataReady() = 0;
+    // Blocks until the next data-ready edge. Returns 1 and the edge time
+    // (steady clock, microseconds) on success, 0 on timeout, -1 on error.
+    virtual int waitDataReady(int timeoutMs, int64_t* timestampUs) = 0;
+
+    // Pulses the hardware reset line.
+    virtual void reset() = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// /dev/spidev with the ADS1263 HAT's control lines on a gpiochip:
+// chip select driven as a GPIO (the HAT does not use CE0), reset as an
+// output and DRDY as a falling-edge line event, so the acquisition thread
+// sleeps in poll() instead of spinning on the pin.
+class LinuxSpiDevice : public SpiDevice {
+public:
+    static constexpr const char* SPI_DEV = "/dev/spidev0.0";
+    static constexpr const char* GPIO_CHIP = "/dev/gpiochip0";
+    static constexpr int RST_LINE = 18;
+    static constexpr int CS_LINE = 22;
+    static constexpr int DRDY_LINE = 17;
+    static constexpr uint32_t SPEED_HZ = 2000000;
+
+    LinuxSpiDevice(const char* spiPath = SPI_DEV, const char* chipPath = GPIO_CHIP);
+    ~LinuxSpiDevice() override;
+
+    bool open() override;
+    void close() override;
+    int transfer(const SpiTransfer* xfers, int count) override;
+    void clearDataReady() override;
+    int waitDataReady(int timeoutMs, int64_t* timestampUs) override;
+    void reset() override;
+    const char* name() const override { return "spidev"; }
+
+private:
+    static constexpr int MAX_XFERS = 8;
+
+    const char* spiPath;
+    const char* chipPath;
+    int spiFd = -1;
+    GpioLine cs;
+    GpioLine rst;
+    GpioLine drdy;
+};
+
+#endif // SPI_DEVICE_H
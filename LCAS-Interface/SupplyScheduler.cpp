@@ -0,0 +1,104 @@
+#include "SupplyScheduler.h"
+#include <QDebug>
+#include <cmath>
+
+SupplyScheduler::SupplyScheduler(PowerSupplyManager* supplies, const std::vector<QString>& addresses,
+                                 QObject* parent)
+    : QObject(parent), supplies(supplies), timer(this) {
+    for (const QString& address : addresses)
+        state[address];
+    connect(&timer, &QTimer::timeout, this, &SupplyScheduler::poll);
+    connect(supplies, &PowerSupplyManager::commandFinished, this, &SupplyScheduler::handleCommandFinished);
+}
+
+void SupplyScheduler::start() {
+    if (pollIntervalMs > 0)
+        timer.start(pollIntervalMs);
+}
+
+void SupplyScheduler::setVoltage(const QString& address, double volts) {
+    request(address, Voltage, volts);
+}
+
+void SupplyScheduler::setCurrent(const QString& address, double amps) {
+    request(address, Current, amps);
+}
+
+void SupplyScheduler::request(const QString& address, Channel channel, double value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Setpoint& setpoint = state[address].setpoints[channel];
+    setpoint.value = value;
+    setpoint.pending = true;
+    if (!setpoint.inFlight)
+        sendLocked(address, channel, setpoint);
+}
+
+void SupplyScheduler::sendLocked(const QString& address, Channel channel, Setpoint& setpoint) {
+    setpoint.pending = false;
+    setpoint.inFlight = channel == Voltage ? supplies->setVoltage(address, setpoint.value)
+                                           : supplies->setCurrent(address, setpoint.value);
+    // 0 means the driver refused it (lockout); nothing is outstanding.
+}
+
+void SupplyScheduler::poll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : state) {
+        Supply& supply = entry.second;
+        // Skip a supply whose previous round has not come back yet rather
+        // than stacking polls up behind a slow bus.
+        if (supply.pollIds[Voltage] || supply.pollIds[Current])
+            continue;
+        supply.pollIds[Voltage] = supplies->queryVoltage(entry.first);
+        supply.pollIds[Current] = supplies->queryCurrent(entry.first);
+    }
+}
+
+void SupplyScheduler::handleCommandFinished(quint64 id, const QString& address, const QByteArray&,
+                                            const QByteArray& reply, bool ok) {
+    bool publish = false;
+    double volts = 0.0, amps = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = state.find(address);
+        if (it == state.end())
+            return;
+        Supply& supply = it->second;
+
+        for (int ch = 0; ch < CHANNELS; ++ch) {
+            Setpoint& setpoint = supply.setpoints[ch];
+            if (setpoint.inFlight == id) {
+                setpoint.inFlight = 0;
+                if (setpoint.pending)
+                    sendLocked(address, (Channel)ch, setpoint);
+                return;
+            }
+        }
+
+        for (int ch = 0; ch < CHANNELS; ++ch) {
+            if (supply.pollIds[ch] != id)
+                continue;
+            supply.pollIds[ch] = 0;
+            bool parsed = false;
+            double value = reply.toDouble(&parsed);
+            if (ok && parsed) {
+                supply.measured[ch] = value;
+                supply.fresh[ch] = true;
+            }
+        }
+        if (supply.fresh[Voltage] && supply.fresh[Current] &&
+            !supply.pollIds[Voltage] && !supply.pollIds[Current]) {
+            supply.fresh[Voltage] = supply.fresh[Current] = false;
+            volts = supply.measured[Voltage];
+            amps = supply.measured[Current];
+            publish = true;
+            if (std::fabs(volts - supply.logged[Voltage]) > logStep ||
+                std::fabs(amps - supply.logged[Current]) > logStep) {
+                supply.logged[Voltage] = volts;
+                supply.logged[Current] = amps;
+                qDebug() << "PS" << address << "MV" << volts << "V MC" << amps << "A";
+            }
+        }
+    }
+    if (publish)
+        emit telemetry(address, volts, amps);
+}
@@ -0,0 +1,73 @@
+#ifndef SUPPLY_SCHEDULER_H
+#define SUPPLY_SCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "PowerSupplyManager.h"
+
+// Sits between the GUI and PowerSupplyManager. Setpoints are coalesced per
+// supply and channel: at most one PV (or PC) per supply is on its way, and
+// when it completes only the newest value requested meanwhile is sent, so
+// dragging a spin box costs a handful of bus transactions instead of one per
+// tick. In the bus time left over, MV?/MC? are polled at Poll priority for
+// every supply and published through telemetry(); values that move by more
+// than the log step are also logged.
+//
+// Lives in the supply driver's thread; setVoltage/setCurrent are safe from
+// any thread.
+class SupplyScheduler : public QObject {
+    Q_OBJECT
+public:
+    SupplyScheduler(PowerSupplyManager* supplies, const std::vector<QString>& addresses,
+                    QObject* parent = nullptr);
+
+    void setVoltage(const QString& address, double volts);
+    void setCurrent(const QString& address, double amps);
+    void setPollIntervalMs(int ms) { pollIntervalMs = ms; }   // 0 disables polling
+
+public slots:
+    void start();
+
+signals:
+    void telemetry(const QString& address, double volts, double amps);
+
+private slots:
+    void poll();
+    void handleCommandFinished(quint64 id, const QString& address, const QByteArray& command,
+                               const QByteArray& reply, bool ok);
+
+private:
+    enum Channel { Voltage, Current, CHANNELS };
+
+    struct Setpoint {
+        bool pending = false;   // a value is waiting to be sent
+        double value = 0.0;
+        quint64 inFlight = 0;   // id of the command on its way, 0 if none
+    };
+
+    struct Supply {
+        Setpoint setpoints[CHANNELS];
+        quint64 pollIds[CHANNELS] = {};
+        double measured[CHANNELS] = {};
+        bool fresh[CHANNELS] = {};
+        double logged[CHANNELS] = {-1.0, -1.0};
+    };
+
+    PowerSupplyManager* supplies;
+    QTimer timer;
+    int pollIntervalMs = 500;
+    double logStep = 0.05;
+
+    std::mutex mutex;
+    std::map<QString, Supply> state;
+
+    void request(const QString& address, Channel channel, double value);
+    void sendLocked(const QString& address, Channel channel, Setpoint& setpoint);
+};
+
+#endif // SUPPLY_SCHEDULER_H
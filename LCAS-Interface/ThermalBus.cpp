@@ -0,0 +1,110 @@
+#include "ThermalBus.h"
+#include "ThermalCameraManager.h"
+#include <unistd.h>
+#include <cstdio>
+#include <ctime>
+
+static void delay(int ms) {
+    timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000};
+    nanosleep(&ts, nullptr);
+}
+
+void D6T_initialSetting(I2CBus& bus) {
+    constexpr uint8_t D6T_SET_ADD = 0x01;
+    constexpr uint8_t D6T_IIR = 0x00;
+    constexpr uint8_t D6T_AVERAGE = 0x04;
+
+    uint8_t dat1[] = {D6T_SET_ADD, (((uint8_t)D6T_IIR << 4) & 0xF0) | (0x0F & (uint8_t)D6T_AVERAGE)};
+    bus.write(ThermalCameraManager::D6T_ADDR, dat1, sizeof(dat1));
+}
+
+// ---- MuxThermalBus ----
+
+bool MuxThermalBus::open(int numCameras) {
+    if (!bus.isOpen() && !bus.open(ThermalCameraManager::I2C_DEV))
+        return false;
+    resetMux();
+    selectedChannel = -1;
+    delay(100);
+    for (int cam = 0; cam < numCameras; ++cam) {
+        selectMuxChannel(cam);
+        D6T_initialSetting(bus);
+    }
+    return true;
+}
+
+void MuxThermalBus::resetMux() {
+    // Requested once and held, so later resets are two line writes.
+    if (!muxReset.isOpen() &&
+        !muxReset.requestOutput(ThermalCameraManager::GPIO_CHIP, ThermalCameraManager::GPIO_LINE, 1, "mux_reset"))
+        return;
+    muxReset.set(0);
+    delay(10);
+    muxReset.set(1);
+}
+
+void MuxThermalBus::selectMuxChannel(int channel) {
+    uint8_t data = 1 << channel;
+    selectedChannel = bus.write(ThermalCameraManager::MUX_ADDR, &data, 1) == 0 ? channel : -1;
+}
+
+int MuxThermalBus::readFrame(int camIndex, uint8_t* buf, int len) {
+    if (selectedChannel == camIndex)
+        return bus.readReg(ThermalCameraManager::D6T_ADDR, ThermalCameraManager::D6T_CMD, buf, len);
+
+    int res = bus.selectAndReadReg(ThermalCameraManager::MUX_ADDR, 1 << camIndex,
+                                   ThermalCameraManager::D6T_ADDR, ThermalCameraManager::D6T_CMD,
+                                   buf, len);
+    selectedChannel = res == 0 ? camIndex : -1;
+    return res;
+}
+
+// ---- KernelMuxThermalBus ----
+
+bool KernelMuxThermalBus::open(int numCameras) {
+    for (int cam = 0; cam < numCameras && cam < MAX_CAMERAS; ++cam) {
+        char path[32];
+        snprintf(path, sizeof(path), ThermalCameraManager::KERNEL_MUX_DEV_FMT, cam);
+        if (access(path, R_OK | W_OK) != 0 || !cameraBus[cam].open(path)) {
+            fprintf(stderr, "Kernel mux adapter %s unavailable\n", path);
+            for (int i = 0; i < cam; ++i)
+                cameraBus[i].close();
+            return false;
+        }
+    }
+
+    // The i2c-mux driver owns channel selection; pulsing the reset line
+    // behind its back would desync its cached channel, so no resetMux here.
+    for (int cam = 0; cam < numCameras && cam < MAX_CAMERAS; ++cam)
+        D6T_initialSetting(cameraBus[cam]);
+    return true;
+}
+
+int KernelMuxThermalBus::readFrame(int camIndex, uint8_t* buf, int len) {
+    if (camIndex < 0 || camIndex >= MAX_CAMERAS)
+        return -1;
+    return cameraBus[camIndex].readReg(ThermalCameraManager::D6T_ADDR,
+                                       ThermalCameraManager::D6T_CMD, buf, len);
+}
+
+// ---- RecordingThermalBus ----
+
+RecordingThermalBus::RecordingThermalBus(std::unique_ptr<ThermalBus> inner, const char* path)
+    : inner(std::move(inner)), file(fopen(path, "ab")) {
+    if (!file) perror("open thermal recording");
+}
+
+RecordingThermalBus::~RecordingThermalBus() {
+    if (file) fclose(file);
+}
+
+int RecordingThermalBus::readFrame(int camIndex, uint8_t* buf, int len) {
+    int res = inner->readFrame(camIndex, buf, len);
+    if (res == 0 && file) {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        uint8_t cam = (uint8_t)camIndex;
+        fwrite(&cam, 1, 1, file);
+        fwrite(buf, 1, len, file);
+    }
+    return res;
+}
@@ -0,0 +1,84 @@
+#ifndef THERMAL_BUS_H
+#define THERMAL_BUS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include "I2CBus.h"
+#include "GpioLine.h"
+
+// Transport between ThermalCameraManager and the D6T cameras. An
+// implementation delivers the raw N_READ-byte 0x4D response for a camera;
+// PEC checking, retries and decoding stay in the manager.
+class ThermalBus {
+public:
+    virtual ~ThermalBus() = default;
+
+    // Bring up the transport and apply the D6T initial setting. Returns false
+    // if this transport is not available on the running system.
+    virtual bool open(int numCameras) = 0;
+
+    // 0 on success, -1 on failure.
+    virtual int readFrame(int camIndex, uint8_t* buf, int len) = 0;
+
+    // True when different cameras may be read concurrently.
+    virtual bool independentCameras() const = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// All cameras on /dev/i2c-1 behind a TCA9548A that we switch ourselves.
+class MuxThermalBus : public ThermalBus {
+public:
+    bool open(int numCameras) override;
+    int readFrame(int camIndex, uint8_t* buf, int len) override;
+    bool independentCameras() const override { return false; }
+    const char* name() const override { return "manual-mux"; }
+
+private:
+    I2CBus bus;
+    GpioLine muxReset;
+    int selectedChannel = -1;  // mux channel last written, -1 if unknown
+
+    void resetMux();
+    void selectMuxChannel(int channel);
+};
+
+// One /dev/i2c-1-N adapter per camera, created by the i2c-mux overlay.
+class KernelMuxThermalBus : public ThermalBus {
+public:
+    static constexpr int MAX_CAMERAS = 4;
+
+    bool open(int numCameras) override;
+    int readFrame(int camIndex, uint8_t* buf, int len) override;
+    bool independentCameras() const override { return true; }
+    const char* name() const override { return "kernel-mux"; }
+
+private:
+    I2CBus cameraBus[MAX_CAMERAS];
+};
+
+// Wraps another bus and appends every raw read to a file as one camera-index
+// byte followed by the N_READ response bytes, the format replayed by
+// SimulatedThermalBus.
+class RecordingThermalBus : public ThermalBus {
+public:
+    RecordingThermalBus(std::unique_ptr<ThermalBus> inner, const char* path);
+    ~RecordingThermalBus() override;
+
+    bool open(int numCameras) override { return inner->open(numCameras); }
+    int readFrame(int camIndex, uint8_t* buf, int len) override;
+    bool independentCameras() const override { return inner->independentCameras(); }
+    const char* name() const override { return inner->name(); }
+
+private:
+    std::unique_ptr<ThermalBus> inner;
+    FILE* file;
+    std::mutex fileMutex;
+};
+
+// Write the D6T averaging/IIR configuration through an open bus.
+void D6T_initialSetting(I2CBus& bus);
+
+#endif // THERMAL_BUS_H
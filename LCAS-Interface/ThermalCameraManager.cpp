@@ -1,171 +1,190 @@
 #include "ThermalCameraManager.h"
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
-#include <linux/i2c.h>
-#include <linux/gpio.h>
+#include "D6TProtocol.h"
+#include "SimulatedThermalBus.h"
+#include "Simd.h"
+#include "FrameStats.h"
+#include "FlightRecorder.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
-#include <ctime>
-#include <sys/stat.h>
 #include <QDebug>
 
-static void delay(int ms) {
-    timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000};
-    nanosleep(&ts, nullptr);
-}
+ThermalCameraManager::ThermalCameraManager(int numCameras, Backend backend)
+    : numCameras(numCameras > MAX_CAMERAS ? MAX_CAMERAS : numCameras),
+      requestedBackend(backend) {}
 
-static uint8_t calc_crc(uint8_t data) {
-    for (int i = 0; i < 8; ++i)
-        data = (data & 0x80) ? (data << 1) ^ 0x07 : (data << 1);
-    return data;
-}
+ThermalCameraManager::~ThermalCameraManager() = default;
+
+std::unique_ptr<ThermalBus> ThermalCameraManager::openBus(bool& opened) {
+    if (requestedBackend == Backend::Simulated) {
+        auto sim = std::make_unique<SimulatedThermalBus>();
+        if (!replayPath.empty())
+            sim->loadReplay(replayPath.c_str());
+        opened = sim->open(numCameras);
+        return sim;
+    }
 
-static bool D6T_checkPEC(uint8_t buf[], int n) {
-    uint8_t crc = calc_crc((ThermalCameraManager::D6T_ADDR << 1) | 1);
-    for (int i = 0; i < n; i++)
-        crc = calc_crc(buf[i] ^ crc);
-    if (crc != buf[n]) {
-        fprintf(stderr, "PEC check failed: %02X != %02X\n", crc, buf[n]);
-        return true;
+    if (requestedBackend != Backend::ManualMux) {
+        auto kernel = std::make_unique<KernelMuxThermalBus>();
+        opened = kernel->open(numCameras);
+        // Only Auto probes; an explicit choice is kept even when it fails.
+        if (opened || requestedBackend == Backend::KernelMux) {
+            if (!opened)
+                fprintf(stderr, "Kernel mux adapters unavailable and LCAS_THERMAL_BACKEND=kernel; "
+                                "no thermal frames\n");
+            return kernel;
+        }
+        fprintf(stderr, "Kernel mux adapters unavailable, using manual mux\n");
+    }
+
+    auto manual = std::make_unique<MuxThermalBus>();
+    opened = manual->open(numCameras);
+    return manual;
+}
+
+bool ThermalCameraManager::initialize() {
+    // Reinitializing reopens the same bus, recorder included; wrapping it
+    // again would nest recorders on one file.
+    bool opened;
+    if (bus) {
+        opened = bus->open(numCameras);
+    } else {
+        bus = openBus(opened);
+        if (!recordPath.empty())
+            bus = std::make_unique<RecordingThermalBus>(std::move(bus), recordPath.c_str());
     }
-    return false;
+
+    qDebug() << "Thermal bus:" << bus->name() << (opened ? "" : "(not open)");
+    return opened;
 }
 
-static int16_t conv8us_s16_le(uint8_t* buf, int n) {
-    return (int16_t)((buf[n + 1] << 8) | buf[n]);
+bool ThermalCameraManager::fetchImage(int channel, ThermalFrame& frame) {
+    uint8_t rbuf[N_READ] = {0};
+    bool ok = false;
+    for (int retry = 0; retry < 5 && !ok; retry++) {
+        if (retry > 0)
+            metrics.count(Metrics::Counter::ReadRetries);
+        int64_t startNs = Metrics::nowNs();
+        bool read = bus->readFrame(channel, rbuf, N_READ) == 0;
+        metrics.record(Metrics::Stage::I2cRead, Metrics::nowNs() - startNs);
+        ok = read && !D6T_checkPEC(D6T_ADDR, rbuf, N_READ - 1);
+        if (!read)
+            metrics.count(Metrics::Counter::ReadErrors);
+        else if (!ok)
+            metrics.count(Metrics::Counter::PecFailures);
+    }
+    if (!ok)
+        metrics.count(Metrics::Counter::FramesUnusable);
+
+    int64_t decodeNs = Metrics::nowNs();
+    frame.ptat = decodeFrame(rbuf, frame.pixels);
+    metrics.record(Metrics::Stage::Decode, Metrics::nowNs() - decodeNs);
+    return ok;
 }
 
-static int i2c_write(uint8_t addr, uint8_t* data, int length) {
-    int fd = open(ThermalCameraManager::I2C_DEV, O_RDWR);
-    if (fd < 0) return perror("open i2c"), -1;
-    if (ioctl(fd, I2C_SLAVE, addr) < 0) return perror("ioctl I2C_SLAVE"), -1;
-    int res = write(fd, data, length);
-    close(fd);
-    return res == length ? 0 : -1;
+int16_t ThermalCameraManager::decodeFrame(const uint8_t* rbuf, int16_t* pixels) {
+    simd::decodeLE16(rbuf + 2, pixels, N_PIXEL);
+    return conv8us_s16_le(rbuf, 0);
 }
 
-static int i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t* data, int len) {
-    int fd = open(ThermalCameraManager::I2C_DEV, O_RDWR);
-    if (fd < 0) return perror("open i2c"), -1;
-    struct i2c_msg msgs[2] = {
-        {addr, 0, 1, &reg},
-        {addr, I2C_M_RD, (uint16_t)len, data}
-    };
-    struct i2c_rdwr_ioctl_data ioctl_data = {msgs, 2};
-    int result = ioctl(fd, I2C_RDWR, &ioctl_data);
-    close(fd);
-    return result == 2 ? 0 : -1;
+cv::Mat ThermalCameraManager::colorize(const int16_t* pixels) {
+    // 0..50 degC onto 0..255; pixels are in 0.1 degC.
+    cv::Mat thermal(N_ROW, N_ROW, CV_16S, const_cast<int16_t*>(pixels));
+    cv::Mat display;
+    thermal.convertTo(display, CV_8U, 255.0 / 500.0);
+    cv::applyColorMap(display, display, cv::COLORMAP_JET);
+    return display;
 }
 
-ThermalCameraManager::ThermalCameraManager(int numCameras) {
-    pixelData.resize(N_PIXEL);
+int16_t ThermalCameraManager::toDeciDegrees(double celsius) {
+    // p / 10.0 > t  <=>  p > floor(10 t) for integer p; the epsilon keeps
+    // thresholds like 40.1 from flooring to 400 through rounding error.
+    double deci = std::floor(celsius * 10.0 + 1e-6);
+    if (deci > INT16_MAX) return INT16_MAX;
+    if (deci < INT16_MIN) return INT16_MIN;
+    return (int16_t)deci;
 }
 
-ThermalCameraManager::~ThermalCameraManager() = default;
+ThermalFramePtr ThermalCameraManager::getThermalFrame(int camIndex) {
+    if (!bus || camIndex < 0 || camIndex >= numCameras)
+        return nullptr;
 
-void ThermalCameraManager::resetMux() {
-    int fd = open(GPIO_CHIP, O_RDONLY);
-    if (fd < 0) { perror("open gpiochip"); return; }
-
-    struct gpiohandle_request req = {};
-    req.lineoffsets[0] = GPIO_LINE;
-    req.flags = GPIOHANDLE_REQUEST_OUTPUT;
-    req.lines = 1;
-    req.default_values[0] = 0;
-    strcpy(req.consumer_label, "mux_reset");
-
-    if (ioctl(fd, GPIO_GET_LINEHANDLE_IOCTL, &req) < 0) {
-        perror("ioctl GPIO_GET_LINEHANDLE_IOCTL");
-        close(fd);
-        return;
+    auto frame = std::make_shared<ThermalFrame>();
+    frame->camIndex = camIndex;
+    {
+        // Buses with independent cameras (kernel mux adapters, simulation) only
+        // serialize a camera against itself; the manual path shares one mux.
+        QMutexLocker locker(bus->independentCameras() ? &cameraMutex[camIndex] : &mutex);
+        frame->pecOk = fetchImage(camIndex, *frame);
+        frame->seq = sequence[camIndex]++;
     }
+    frame->timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 
-    struct gpiohandle_data data = {};
-    data.values[0] = 0;
-    ioctl(req.fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
-    delay(10);
-    data.values[0] = 1;
-    ioctl(req.fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
-    close(req.fd);
-    close(fd);
+    // The frame owns its pixels, so the rest needs no lock.
+    frame->stats = computeFrameStats(frame->pixels, N_ROW, N_ROW, toDeciDegrees(tempThreshold.load()));
+    if (flightRecorder)
+        flightRecorder->recordFrame(camIndex, frame->ptat, frame->pixels, frame->timestampUs);
+    return frame;
 }
 
-void ThermalCameraManager::selectMuxChannel(int channel) {
-    uint8_t data = 1 << channel;
-    i2c_write(MUX_ADDR, &data, 1);
+FrameStats ThermalCameraManager::checkAndSaveIfThresholdExceeded(const ThermalFramePtr& frame) {
+    if (!frame || !frame->stats.exceeded())
+        return frame ? frame->stats : FrameStats();
+
+    const int camIndex = frame->camIndex;
+    const FrameStats& stats = frame->stats;
+
+    qWarning() << "Camera" << camIndex << "over threshold:" << stats.overThreshold
+               << "pixels, max" << stats.max / 10.0 << "C at (" << stats.maxX << "," << stats.maxY << ")";
+
+    // Encoding and disk I/O happen on the writer's thread, which shares the
+    // frame rather than copying it.
+    AlertWriter::Job job;
+    job.frame = frame;
+    job.time = std::chrono::system_clock::now();
+    alertWriter.submit(std::move(job));
+    return stats;
 }
 
-void ThermalCameraManager::initialSetting() {
-    constexpr uint8_t D6T_SET_ADD = 0x01;
-    constexpr uint8_t D6T_IIR = 0x00;
-    constexpr uint8_t D6T_AVERAGE = 0x04;
+void ThermalCameraManager::setThreshold(double value) {
+    tempThreshold.store(value);
+}
 
-    uint8_t dat1[] = {D6T_SET_ADD, (((uint8_t)D6T_IIR << 4) & 0xF0) | (0x0F & (uint8_t)D6T_AVERAGE)};
-    i2c_write(D6T_ADDR, dat1, sizeof(dat1));
+double ThermalCameraManager::getThreshold() const {
+    return tempThreshold.load();
 }
 
-void ThermalCameraManager::initialize() {
-    resetMux();
-    delay(100);
-    for (int cam = 0; cam < 4; ++cam) {
-        selectMuxChannel(cam);
-        initialSetting();
-    }
+void ThermalCameraManager::setBackend(Backend backend) {
+    requestedBackend = backend;
 }
 
-cv::Mat ThermalCameraManager::fetchImage() {
-    uint8_t rbuf[N_READ] = {0};
-    for (int retry = 0; retry < 5; retry++) {
-        if (i2c_read_reg(D6T_ADDR, D6T_CMD, rbuf, N_READ) == 0 &&
-            !D6T_checkPEC(rbuf, N_READ - 1)) break;
-    }
+void ThermalCameraManager::setBus(std::unique_ptr<ThermalBus> customBus) {
+    bus = std::move(customBus);
+}
 
-    ptat = (double)conv8us_s16_le(rbuf, 0) / 10.0;
-    for (int i = 0; i < N_PIXEL; i++) {
-        int16_t itemp = conv8us_s16_le(rbuf, 2 + 2 * i);
-        pixelData[i] = (double)itemp / 10.0;
-    }
+void ThermalCameraManager::setReplayFile(const char* path) {
+    replayPath = path ? path : "";
+}
 
-    cv::Mat thermal(N_ROW, N_ROW, CV_64F, pixelData.data());
-    cv::Mat display;
-    thermal.convertTo(display, CV_8U, 255.0 / 50.0);
-    cv::applyColorMap(display, display, cv::COLORMAP_JET);
-    return display;
+void ThermalCameraManager::setRecordFile(const char* path) {
+    recordPath = path ? path : "";
 }
 
-cv::Mat ThermalCameraManager::getThermalFrame(int camIndex) {
-    QMutexLocker locker(&mutex);
-    selectMuxChannel(camIndex);
-    return fetchImage();
-}
-
-bool ThermalCameraManager::checkAndSaveIfThresholdExceeded(int camIndex, const cv::Mat& displayImage) {
-    double currentThreshold = tempThreshold.load();
-    qDebug() << "Current threshold is:" << currentThreshold;
-    
-    for (int i = 0; i < N_PIXEL; i++) {
-        if (pixelData[i] > currentThreshold) {
-            time_t now = time(0);
-            struct tm* t = localtime(&now);
-            char filename[256];
-            snprintf(filename, sizeof(filename), "thermal_alerts/cam%d_%04d%02d%02d_%02d%02d%02d.jpg",
-                     camIndex, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-                     t->tm_hour, t->tm_min, t->tm_sec);
-            mkdir("thermal_alerts", 0755);
-            cv::imwrite(filename, displayImage);
-            return true;
-        }
-    }
-    return false;
+void ThermalCameraManager::setFlightRecorder(FlightRecorder* recorder) {
+    flightRecorder = recorder;
 }
 
-void ThermalCameraManager::setThreshold(double value) {
-    tempThreshold.store(value);
+const char* ThermalCameraManager::busName() const {
+    return bus ? bus->name() : "none";
 }
 
-double ThermalCameraManager::getThreshold() const {
-    return tempThreshold.load();
+ThermalCameraManager::Backend ThermalCameraManager::backendFromString(const char* name) {
+    if (name && strcmp(name, "manual") == 0) return Backend::ManualMux;
+    if (name && strcmp(name, "kernel") == 0) return Backend::KernelMux;
+    if (name && strcmp(name, "sim") == 0) return Backend::Simulated;
+    return Backend::Auto;
 }
@@ -5,24 +5,65 @@
 #include <vector>
 #include <QMutex>
 #include <atomic>
+#include <memory>
+#include <string>
+#include "ThermalBus.h"
+#include "FrameStats.h"
+#include "ThermalFrame.h"
+#include "AlertWriter.h"
+
+class FlightRecorder;
 
 class ThermalCameraManager {
 public:
-    ThermalCameraManager(int numCameras = 4);
+    // How frames reach the cameras behind the TCA9548A.
+    //  ManualMux - one /dev/i2c-1 handle, channel written by us, global lock
+    //  KernelMux - one /dev/i2c-1-N adapter per camera from the i2c-mux overlay;
+    //              never falls back, so missing adapters leave the cameras dark
+    //  Auto      - KernelMux if every camera adapter exists, else ManualMux
+    //  Simulated - synthetic or replayed frames, no hardware needed
+    enum class Backend { Auto, ManualMux, KernelMux, Simulated };
+
+    ThermalCameraManager(int numCameras = 4, Backend backend = Backend::Auto);
     ~ThermalCameraManager();
 
-    void initialize();
-    cv::Mat getThermalFrame(int camIndex);
-    bool checkAndSaveIfThresholdExceeded(int camIndex, const cv::Mat& displayImage);
+    // Bus selection; all take effect on initialize().
+    void setBackend(Backend backend);
+    void setBus(std::unique_ptr<ThermalBus> customBus);  // overrides the backend
+    void setReplayFile(const char* path);   // Simulated backend plays this back
+    void setRecordFile(const char* path);   // tee every raw read to this file; not for setBus()
+    void setFlightRecorder(FlightRecorder* recorder);  // fed every frame
+    const char* busName() const;
+    static Backend backendFromString(const char* name);
+
+    // False if the bus did not open; reads then fail and are counted.
+    bool initialize();
+    // Reads, decodes and evaluates one frame. Returns null if the
+    // camera index is out of range or the bus is not open.
+    ThermalFramePtr getThermalFrame(int camIndex);
+    // Queues an alert image for a frame whose stats exceed the trip threshold.
+    // Tripping itself is SafetyEngine's job. Returns the frame's stats.
+    FrameStats checkAndSaveIfThresholdExceeded(const ThermalFramePtr& frame);
+    const AlertWriter& alerts() const { return alertWriter; }
     
     void setThreshold(double value);    
     double getThreshold() const;
+
+    // Per-frame stages of getThermalFrame, public
+    // so the benchmark can time them in isolation. Temperatures stay in the
+    // sensor's native int16 0.1 degC units throughout.
+    static int16_t decodeFrame(const uint8_t* rbuf, int16_t* pixels);  // returns PTAT
+    static cv::Mat colorize(const int16_t* pixels);
+    static int16_t toDeciDegrees(double celsius);
     
-    static constexpr int N_ROW = 32;
-    static constexpr int N_PIXEL = N_ROW * N_ROW;
+    static constexpr int N_ROW = ThermalFrame::N_ROW;
+    static constexpr int N_PIXEL = ThermalFrame::N_PIXEL;
     static constexpr int N_READ = (N_PIXEL + 1) * 2 + 1;
 
+    static constexpr int MAX_CAMERAS = 4;
+
     static constexpr const char* I2C_DEV = "/dev/i2c-1";
+    static constexpr const char* KERNEL_MUX_DEV_FMT = "/dev/i2c-1-%d";
     static constexpr const char* GPIO_CHIP = "/dev/gpiochip0";
     static constexpr int GPIO_LINE = 23;
     static constexpr int D6T_ADDR = 0x0A;
@@ -30,18 +71,25 @@ public:
     static constexpr int MUX_ADDR = 0x70;
 
 private:
+    int numCameras;
+    Backend requestedBackend;
+    std::string replayPath;
+    std::string recordPath;
+    std::unique_ptr<ThermalBus> bus;
+    FlightRecorder* flightRecorder = nullptr;
+
     QMutex mutex;
+    QMutex cameraMutex[MAX_CAMERAS];
 
-    void resetMux();
-    void selectMuxChannel(int channel);
-    void initialSetting();
+    std::unique_ptr<ThermalBus> openBus(bool& opened);
     
-    cv::Mat fetchImage();
+    bool fetchImage(int channel, ThermalFrame& frame);
 
-    double ptat;
-    std::vector<double> pixelData;
+    uint64_t sequence[MAX_CAMERAS] = {};
 
     std::atomic<double> tempThreshold = 40.0;
+
+    AlertWriter alertWriter;
 };
 
 #endif // THERMAL_CAMERA_MANAGER_H
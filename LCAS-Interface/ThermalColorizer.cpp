@@ -0,0 +1,64 @@
+#include "ThermalColorizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Piecewise-linear jet, the same shape as cv::COLORMAP_JET.
+static QRgb jet(double x) {
+    auto channel = [](double v) { return (int)std::lround(255.0 * std::min(1.0, std::max(0.0, v))); };
+    return qRgb(channel(1.5 - std::fabs(4.0 * x - 3.0)),
+                channel(1.5 - std::fabs(4.0 * x - 2.0)),
+                channel(1.5 - std::fabs(4.0 * x - 1.0)));
+}
+
+ThermalColorizer::ThermalColorizer() : palette(256) {
+    for (int i = 0; i < 256; ++i)
+        palette[i] = jet(i / 255.0);
+}
+
+void ThermalColorizer::setFixedRange(int16_t lo, int16_t hi) {
+    fixedLow = lo;
+    fixedHigh = hi > lo ? hi : (int16_t)(lo + 1);
+}
+
+ThermalColorizer::Range ThermalColorizer::rangeFromString(const char* name) {
+    if (name && strcmp(name, "auto") == 0) return Range::Auto;
+    if (name && strcmp(name, "threshold") == 0) return Range::Threshold;
+    return Range::Fixed;
+}
+
+const QImage& ThermalColorizer::render(const ThermalFrame& frame) {
+    int lo = fixedLow, hi = fixedHigh;
+    if (mode == Range::Auto) {
+        lo = frame.stats.min;
+        hi = frame.stats.max;
+        if (hi - lo < MIN_SPAN) {
+            int mid = (lo + hi) / 2;
+            lo = mid - MIN_SPAN / 2;
+            hi = lo + MIN_SPAN;
+        }
+    } else if (mode == Range::Threshold) {
+        hi = frame.stats.threshold > lo ? frame.stats.threshold : lo + MIN_SPAN;
+    }
+    low = (int16_t)lo;
+    high = (int16_t)hi;
+
+    QImage& image = images[frame.camIndex & 3];
+    if (image.isNull()) {
+        image = QImage(ThermalFrame::N_ROW, ThermalFrame::N_ROW, QImage::Format_Indexed8);
+        image.setColorTable(palette);
+    }
+
+    // index = round((p - lo) * 255 / (hi - lo)) in 16.16 fixed point,
+    // clamped to the palette.
+    const int32_t scale = (int32_t)(((int64_t)255 << 16) / (hi - lo));
+    for (int y = 0; y < ThermalFrame::N_ROW; ++y) {
+        const int16_t* src = frame.pixels + y * ThermalFrame::N_ROW;
+        uchar* dst = image.scanLine(y);
+        for (int x = 0; x < ThermalFrame::N_ROW; ++x) {
+            int32_t d = std::min(std::max((int32_t)src[x] - lo, 0), hi - lo);
+            dst[x] = (uchar)((d * scale + 0x8000) >> 16);
+        }
+    }
+    return image;
+}
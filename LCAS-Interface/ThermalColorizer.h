@@ -0,0 +1,48 @@
+#ifndef THERMAL_COLORIZER_H
+#define THERMAL_COLORIZER_H
+
+#include <QImage>
+#include <QVector>
+#include <cstdint>
+#include "ThermalFrame.h"
+
+// GUI-side renderer from raw deci-degree pixels to an Indexed8 QImage. Each
+// pixel becomes a palette index in one fixed-point pass; the 256-entry jet
+// colour table is built once and shared by every image.
+class ThermalColorizer {
+public:
+    // Which temperatures map to the ends of the palette.
+    //  Fixed     - [fixedLow, fixedHigh], 0..50 degC by default
+    //  Auto      - the frame's own min..max, widened to at least minSpan
+    //  Threshold - fixedLow up to the trip threshold, so red means tripping
+    enum class Range { Fixed, Auto, Threshold };
+
+    ThermalColorizer();
+
+    void setRange(Range range) { mode = range; }
+    Range range() const { return mode; }
+    void setFixedRange(int16_t low, int16_t high);   // 0.1 degC
+    static Range rangeFromString(const char* name);  // "fixed", "auto", "threshold"
+
+    // Renders into a per-camera buffer that is reused while nobody else holds
+    // a reference to it.
+    const QImage& render(const ThermalFrame& frame);
+
+    // Palette bounds of the last render, 0.1 degC.
+    int16_t lastLow() const { return low; }
+    int16_t lastHigh() const { return high; }
+
+private:
+    static constexpr int MIN_SPAN = 20;   // 2 degC, keeps Auto from amplifying noise
+
+    Range mode = Range::Fixed;
+    int16_t fixedLow = 0;
+    int16_t fixedHigh = 500;
+    int16_t low = 0;
+    int16_t high = 500;
+
+    QVector<QRgb> palette;
+    QImage images[4];
+};
+
+#endif // THERMAL_COLORIZER_H
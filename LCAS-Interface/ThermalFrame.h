@@ -0,0 +1,27 @@
+#ifndef THERMAL_FRAME_H
+#define THERMAL_FRAME_H
+
+#include <cstdint>
+#include <memory>
+#include "FrameStats.h"
+
+// One D6T-32L read, built once by ThermalCameraManager and never modified
+// afterwards. Consumers (GUI, alert writer, flight recorder) share it through
+// ThermalFramePtr, so crossing threads or queued signals copies a pointer,
+// not pixels. Colorizing is left to whoever displays or saves the frame.
+struct ThermalFrame {
+    static constexpr int N_ROW = 32;
+    static constexpr int N_PIXEL = N_ROW * N_ROW;
+
+    int camIndex = -1;
+    uint64_t seq = 0;           // per-camera read counter
+    int64_t timestampUs = 0;    // steady_clock time the read completed
+    int16_t ptat = 0;           // 0.1 degC
+    bool pecOk = false;         // false if every retry failed the PEC check
+    FrameStats stats;           // against the threshold in force at capture
+    int16_t pixels[N_PIXEL];    // row-major, 0.1 degC
+};
+
+using ThermalFramePtr = std::shared_ptr<const ThermalFrame>;
+
+#endif // THERMAL_FRAME_H
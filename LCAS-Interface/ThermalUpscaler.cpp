@@ -0,0 +1,94 @@
+#include "ThermalUpscaler.h"
+#include "Simd.h"
+#include <cmath>
+
+// Pixel-centre mapping: dst i samples src (i + 0.5) * in / out - 0.5.
+static void buildAxis(int in, int out, std::vector<int16_t>& index, std::vector<int16_t>& weight) {
+    index.resize(out);
+    weight.resize(out);
+    for (int i = 0; i < out; ++i) {
+        double s = (i + 0.5) * in / out - 0.5;
+        if (s < 0) s = 0;
+        int i0 = (int)s;
+        if (i0 >= in - 1) {
+            index[i] = (int16_t)(in - 1);
+            weight[i] = 0;
+        } else {
+            index[i] = (int16_t)i0;
+            weight[i] = (int16_t)std::floor((s - i0) * 128.0);
+        }
+    }
+}
+
+void ThermalUpscaler::plan(int srcW, int srcH, int dstW, int dstH) {
+    inW = srcW;
+    inH = srcH;
+    outW = dstW;
+    outH = dstH;
+    stride = (outW + simd::I16_LANES - 1) / simd::I16_LANES * simd::I16_LANES;
+
+    buildAxis(inW, outW, xIndex, xWeight);
+    buildAxis(inH, outH, yIndex, yWeight);
+    rows.assign((size_t)inH * stride, 0);
+    output = QImage(outW, outH, QImage::Format_RGB32);
+}
+
+const QImage& ThermalUpscaler::scale(const QImage& indexed, const QSize& target) {
+    const int srcW = indexed.width(), srcH = indexed.height();
+    if (srcW < 1 || srcH < 1 || target.width() < 1 || target.height() < 1) {
+        output = QImage();
+        return output;
+    }
+
+    // Fit inside target with the source's aspect ratio.
+    int dstW = target.width();
+    int dstH = (int)((int64_t)dstW * srcH / srcW);
+    if (dstH > target.height()) {
+        dstH = target.height();
+        dstW = (int)((int64_t)dstH * srcW / srcH);
+    }
+    if (dstW < 1) dstW = 1;
+    if (dstH < 1) dstH = 1;
+
+    if (srcW != inW || srcH != inH || dstW != outW || dstH != outH)
+        plan(srcW, srcH, dstW, dstH);
+
+    // Horizontal pass: each source row to outW rounded 8-bit indices.
+    for (int y = 0; y < inH; ++y) {
+        const uchar* src = indexed.constScanLine(y);
+        int16_t* row = &rows[(size_t)y * stride];
+        for (int x = 0; x < outW; ++x) {
+            int i0 = xIndex[x];
+            int i1 = i0 + (i0 < inW - 1);
+            row[x] = (int16_t)(src[i0] + (((src[i1] - src[i0]) * xWeight[x] + 64) >> 7));
+        }
+    }
+
+    // Vertical pass: |diff| <= 255 and weight <= 127 keep every product in
+    // int16, so eight pixels go through per step.
+    const QVector<QRgb> table = indexed.colorTable();
+    QRgb palette[256];
+    for (int i = 0; i < 256; ++i)
+        palette[i] = i < (int)table.size() ? table[i] : qRgb(i, i, i);
+
+    const simd::i16x8 round = simd::splat(64);
+    alignas(16) int16_t lane[simd::I16_LANES];
+    for (int y = 0; y < outH; ++y) {
+        int r0 = yIndex[y];
+        int r1 = r0 + (r0 < inH - 1);
+        const int16_t* top = &rows[(size_t)r0 * stride];
+        const int16_t* bottom = &rows[(size_t)r1 * stride];
+        const simd::i16x8 w = simd::splat(yWeight[y]);
+        QRgb* dst = reinterpret_cast<QRgb*>(output.scanLine(y));
+
+        for (int x = 0; x < outW; x += simd::I16_LANES) {
+            simd::i16x8 a = simd::load(top + x);
+            simd::i16x8 d = simd::sub(simd::load(bottom + x), a);
+            simd::store(lane, simd::add(a, simd::sra(simd::add(simd::mullo(d, w), round), 7)));
+            int n = outW - x < simd::I16_LANES ? outW - x : simd::I16_LANES;
+            for (int i = 0; i < n; ++i)
+                dst[x + i] = palette[lane[i]];
+        }
+    }
+    return output;
+}
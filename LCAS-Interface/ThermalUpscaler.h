@@ -0,0 +1,39 @@
+#ifndef THERMAL_UPSCALER_H
+#define THERMAL_UPSCALER_H
+
+#include <QImage>
+#include <QSize>
+#include <cstdint>
+#include <vector>
+
+// Bilinear upscaler from a small Indexed8 thermal image to an RGB32 image
+// that fits a label, keeping the aspect ratio. Palette indices are linear in
+// temperature, so interpolating them and looking up the colour afterwards
+// is interpolating temperature.
+//
+// Source and destination coordinates, 7-bit weights and the output buffer
+// are cached and only rebuilt when either size changes. Each frame runs a
+// scalar horizontal pass over the source rows (inH x outW) and a vector
+// vertical pass over the output (outH x outW), fused with the palette lookup.
+class ThermalUpscaler {
+public:
+    // The returned image is reused by the next call.
+    const QImage& scale(const QImage& indexed, const QSize& target);
+
+private:
+    int inW = 0, inH = 0;
+    int outW = 0, outH = 0;
+    int stride = 0;                  // outW rounded up to whole vectors
+
+    std::vector<int16_t> xIndex;     // left source column per output column
+    std::vector<int16_t> xWeight;    // 0..127 toward the right column
+    std::vector<int16_t> yIndex;     // top source row per output row
+    std::vector<int16_t> yWeight;    // 0..127 toward the bottom row
+    std::vector<int16_t> rows;       // source rows scaled horizontally, inH x stride
+
+    QImage output;
+
+    void plan(int srcW, int srcH, int dstW, int dstH);
+};
+
+#endif // THERMAL_UPSCALER_H
@@ -1,12 +1,13 @@
 #include "ThermalWorker.h"
 #include "ThermalCameraManager.h"
+#include "SafetyEngine.h"
 #include <QThread>
 #include <QDebug>
 
-extern ThermalCameraManager thermalManager;
-
-ThermalWorker::ThermalWorker(int cameraIndex, QObject *parent)
-    : QObject(parent), camIndex(cameraIndex), captureTimer(nullptr) {}
+ThermalWorker::ThermalWorker(int cameraIndex, ThermalCameraManager* manager, SafetyEngine* engine,
+                             QObject *parent)
+    : QObject(parent), camIndex(cameraIndex), thermalManager(manager), safetyEngine(engine),
+      captureTimer(nullptr) {}
 
 void ThermalWorker::start() {
    
@@ -27,12 +28,13 @@ void ThermalWorker::stop() {
 }
 
 void ThermalWorker::process() {
-    cv::Mat frame = thermalManager.getThermalFrame(camIndex);
-    if (frame.empty()) {
-        //qDebug() << "Camera" << camIndex << "returned empty frame.";
+    ThermalFramePtr frame = thermalManager->getThermalFrame(camIndex);
+    if (!frame) {
+        //qDebug() << "Camera" << camIndex << "returned no frame.";
         return;
     }
-    bool triggered = thermalManager.checkAndSaveIfThresholdExceeded(camIndex, frame);
-    //qDebug() << "ThermalWorker emitting frameReady for cam" << camIndex << ", triggered =" << triggered;
-    emit frameReady(camIndex, frame.clone(), triggered); 
+    safetyEngine->submitThermal(frame);
+    thermalManager->checkAndSaveIfThresholdExceeded(frame);
+    //qDebug() << "ThermalWorker emitting frameReady for cam" << camIndex << ", triggered =" << frame->stats.exceeded();
+    emit frameReady(frame);
 }
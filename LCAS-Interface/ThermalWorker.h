@@ -1,23 +1,29 @@
 #include <QObject>
 #include <QTimer>
-#include <opencv2/opencv.hpp>
+#include "ThermalFrame.h"
+
+class ThermalCameraManager;
+class SafetyEngine;
 
 class ThermalWorker : public QObject {
     Q_OBJECT
 public:
-    explicit ThermalWorker(int cameraIndex, QObject *parent = nullptr);
+    ThermalWorker(int cameraIndex, ThermalCameraManager* manager, SafetyEngine* engine,
+                  QObject *parent = nullptr);
 
 public slots:
     void start();  // start capturing
     void stop();   // stop capturing
 
 signals:
-    void frameReady(int camIndex, const cv::Mat& frame, bool thresholdExceeded);
+    void frameReady(const ThermalFramePtr& frame);
 
 private slots:
     void process();
 
 private:
     int camIndex;
+    ThermalCameraManager* thermalManager;
+    SafetyEngine* safetyEngine;
     QTimer* captureTimer;
 };
@@ -0,0 +1,319 @@
+// Microbenchmark for the per-frame thermal path.
+//
+// Each stage is timed in isolation over a set of raw frames produced by
+// SimulatedThermalBus, so no sensors are needed. Results are ns/frame and
+// heap allocations/frame, written as one JSON object per line on stdout
+// (or an aligned table with --text) so runs can be diffed between releases.
+//
+//   ./thermal_bench [-n iterations] [-W width] [-H height] [--text]
+
+#include <QApplication>
+#include <QImage>
+#include <QPixmap>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ThermalCameraManager.h"
+#include "SimulatedThermalBus.h"
+#include "D6TProtocol.h"
+#include "ImageConvert.h"
+#include "FrameStats.h"
+#include "ThermalColorizer.h"
+#include "ThermalUpscaler.h"
+#include "Ads1263.h"
+#include "SimulatedAds1263.h"
+#include "AdcScanPlan.h"
+#include "AdcFilterBank.h"
+#include "AdcToneDetector.h"
+#include "Metrics.h"
+
+// ---- Allocation counting ----
+// Interpose the C allocator so both operator new and OpenCV's fastMalloc
+// are counted.
+
+static std::atomic<unsigned long> g_allocs{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+
+void* malloc(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t align, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(align, size);
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** out, size_t align, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = __libc_memalign(align, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+}
+#endif
+
+// ---- Stage runner ----
+
+struct StageResult {
+    const char* name;
+    long iterations;
+    double nsPerFrame;
+    double allocsPerFrame;
+};
+
+static volatile double g_sink;
+
+template <typename Fn>
+static StageResult runStage(const char* name, long iterations, Fn&& fn) {
+    double sink = 0;
+    for (long i = 0; i < iterations / 10 + 1; ++i)
+        sink += fn(i);
+
+    unsigned long allocs0 = g_allocs.load();
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+        sink += fn(i);
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long allocs1 = g_allocs.load();
+
+    g_sink = sink;
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    return {name, iterations, ns / iterations, (double)(allocs1 - allocs0) / iterations};
+}
+
+static void printResult(const StageResult& r, bool text) {
+    if (text) {
+        printf("%-16s %12.1f ns/frame %8.2f allocs/frame  (%ld iterations)\n",
+               r.name, r.nsPerFrame, r.allocsPerFrame, r.iterations);
+    } else {
+        printf("{\"bench\":\"thermal\",\"stage\":\"%s\",\"iterations\":%ld,"
+               "\"ns_per_frame\":%.1f,\"allocs_per_frame\":%.2f}\n",
+               r.name, r.iterations, r.nsPerFrame, r.allocsPerFrame);
+    }
+    fflush(stdout);
+}
+
+static void silenceQtMessages(QtMsgType, const QMessageLogContext&, const QString&) {}
+
+int main(int argc, char* argv[]) {
+    long iterations = 20000;
+    int width = 400, height = 400;
+    bool text = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-W") && i + 1 < argc) width = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-H") && i + 1 < argc) height = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--text")) text = true;
+        else {
+            fprintf(stderr, "usage: %s [-n iterations] [-W width] [-H height] [--text]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+
+    // QPixmap needs a GUI application; render offscreen unless told otherwise.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    qInstallMessageHandler(silenceQtMessages);
+
+    constexpr int N_FRAMES = 64;
+    constexpr int N_READ = ThermalCameraManager::N_READ;
+    constexpr int N_PIXEL = ThermalCameraManager::N_PIXEL;
+
+    // Precompute the input of every stage so each one is timed on its own.
+    SimulatedThermalBus sim;
+    sim.open(ThermalCameraManager::MAX_CAMERAS);
+    std::vector<std::vector<uint8_t>> raw(N_FRAMES, std::vector<uint8_t>(N_READ));
+    std::vector<std::vector<int16_t>> pixels(N_FRAMES, std::vector<int16_t>(N_PIXEL));
+    std::vector<cv::Mat> colored(N_FRAMES);
+    std::vector<QImage> images(N_FRAMES);
+    for (int f = 0; f < N_FRAMES; ++f) {
+        sim.readFrame(f % ThermalCameraManager::MAX_CAMERAS, raw[f].data(), N_READ);
+        ThermalCameraManager::decodeFrame(raw[f].data(), pixels[f].data());
+        colored[f] = ThermalCameraManager::colorize(pixels[f].data());
+        images[f] = matToQImage(colored[f]);
+    }
+
+    ThermalCameraManager manager;
+    const int16_t threshold = ThermalCameraManager::toDeciDegrees(manager.getThreshold());
+    std::vector<int16_t> scratch(N_PIXEL);
+
+    printResult(runStage("pec", iterations, [&](long i) {
+        return (double)D6T_checkPEC(ThermalCameraManager::D6T_ADDR, raw[i % N_FRAMES].data(), N_READ - 1);
+    }), text);
+
+    // The bit-at-a-time CRC that D6T_checkPEC used before the table engine.
+    printResult(runStage("pec_bitwise", iterations, [&](long i) {
+        const uint8_t* buf = raw[i % N_FRAMES].data();
+        uint8_t addr = (ThermalCameraManager::D6T_ADDR << 1) | 1;
+        return (double)(crc8_bitwise(crc8_shift8(addr), buf, N_READ - 1) != buf[N_READ - 1]);
+    }), text);
+
+    printResult(runStage("decode", iterations, [&](long i) {
+        return (double)ThermalCameraManager::decodeFrame(raw[i % N_FRAMES].data(), scratch.data());
+    }), text);
+
+    printResult(runStage("colorize", iterations, [&](long i) {
+        cv::Mat display = ThermalCameraManager::colorize(pixels[i % N_FRAMES].data());
+        return (double)display.data[0];
+    }), text);
+
+    printResult(runStage("frame_stats", iterations, [&](long i) {
+        FrameStats stats = computeFrameStats(pixels[i % N_FRAMES].data(), ThermalCameraManager::N_ROW,
+                                             ThermalCameraManager::N_ROW, threshold);
+        return (double)stats.overThreshold;
+    }), text);
+
+    printResult(runStage("mat_to_qimage", iterations, [&](long i) {
+        return (double)matToQImage(colored[i % N_FRAMES]).width();
+    }), text);
+
+    // Raw pixels to a displayable image in one pass, replacing colorize +
+    // mat_to_qimage on the display path.
+    std::vector<ThermalFramePtr> frames(N_FRAMES);
+    for (int f = 0; f < N_FRAMES; ++f) {
+        auto frame = std::make_shared<ThermalFrame>();
+        frame->camIndex = f % ThermalCameraManager::MAX_CAMERAS;
+        memcpy(frame->pixels, pixels[f].data(), sizeof(frame->pixels));
+        frame->stats = computeFrameStats(frame->pixels, ThermalCameraManager::N_ROW,
+                                         ThermalCameraManager::N_ROW, threshold);
+        frames[f] = frame;
+    }
+    ThermalColorizer colorizer;
+    printResult(runStage("lut_colorize", iterations, [&](long i) {
+        return (double)colorizer.render(*frames[i % N_FRAMES]).constBits()[0];
+    }), text);
+
+    ThermalUpscaler upscaler;
+    std::vector<QImage> indexed(N_FRAMES);
+    for (int f = 0; f < N_FRAMES; ++f)
+        indexed[f] = colorizer.render(*frames[f]).copy();
+    printResult(runStage("upscale", iterations, [&](long i) {
+        return (double)upscaler.scale(indexed[i % N_FRAMES], QSize(width, height)).width();
+    }), text);
+
+    printResult(runStage("pixmap_scale", iterations, [&](long i) {
+        QPixmap pixmap = QPixmap::fromImage(images[i % N_FRAMES]).scaled(
+            width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        return (double)pixmap.width();
+    }), text);
+
+    // Whole acquisition path through the simulated bus. The threshold sits
+    // above the simulator's peak so no alert JPEGs are written.
+    manager.setBackend(ThermalCameraManager::Backend::Simulated);
+    manager.setThreshold(1000.0);
+    manager.initialize();
+    printResult(runStage("pipeline", iterations, [&](long i) {
+        int cam = (int)(i % ThermalCameraManager::MAX_CAMERAS);
+        ThermalFramePtr frame = manager.getThermalFrame(cam);
+        return (double)manager.checkAndSaveIfThresholdExceeded(frame).overThreshold;
+    }), text);
+
+    // One four-channel stray-light scan through the ADS1263 driver against
+    // the simulated chip on its virtual clock: the CPU cost per scan. This is
+    // the one-frame-per-command path; adc_scan_batched is the planned scan.
+    SimulatedAds1263::Options adcOptions;
+    adcOptions.realTime = false;
+    SimulatedAds1263 adcDevice(adcOptions);
+    Ads1263 adc(adcDevice);
+    adcDevice.open();
+    adc.init();
+    printResult(runStage("adc_scan", iterations, [&](long) {
+        double sum = 0;
+        for (int ch = 0; ch < 4; ++ch) {
+            int64_t edgeUs;
+            int32_t code = 0;
+            adc.selectDiffChannel(ch);
+            adcDevice.waitDataReady(1000, &edgeUs);
+            adc.readAdc1(code);
+            sum += Ads1263::codeToVolts(code);
+        }
+        return sum;
+    }), text);
+
+    ChannelPlan plan = planChannel(ChannelSpec());
+    adc.selectDiffChannel(0, plan.config);
+    printResult(runStage("adc_scan_batched", iterations, [&](long) {
+        double sum = 0;
+        for (int ch = 0; ch < 4; ++ch) {
+            for (int k = 0; k < plan.averages; ++k) {
+                int64_t edgeUs;
+                int32_t code = 0;
+                adcDevice.waitDataReady(1000, &edgeUs);
+                if (k == plan.averages - 1)
+                    adc.readAdc1AndSelect(code, (ch + 1) % 4, plan.config);
+                else
+                    adc.readAdc1(code);
+                sum += Ads1263::codeToVolts(code);
+            }
+        }
+        return sum;
+    }), text);
+
+    // The safety engine's per-scan filtering: four channels through the
+    // median, CIC and window stages. Inputs are precomputed scans with a
+    // spike every 64th so the median does real work.
+    constexpr int N_SCANS = 1024;
+    std::vector<double> scans(N_SCANS * 4);
+    for (int s = 0; s < N_SCANS; ++s)
+        for (int ch = 0; ch < 4; ++ch)
+            scans[s * 4 + ch] = 0.2 + 0.15 * ch + (s % 64 == 0 ? 1.0 : 1e-6 * (s % 7));
+    AdcFilterBank filter;
+    AdcFilterBank::Output filtered = {};
+    printResult(runStage("adc_filter", iterations, [&](long i) {
+        filter.push(&scans[(i % N_SCANS) * 4], 4, 0xF, filtered);
+        return filtered.mean[0];
+    }), text);
+
+    // Four modulation frequencies on four channels, on the same scans.
+    AdcToneDetector::Config toneConfig;
+    toneConfig.tones = AdcToneDetector::MAX_TONES;
+    for (int k = 0; k < toneConfig.tones; ++k)
+        toneConfig.toneHz[k] = 37.0 * (k + 1);
+    AdcToneDetector tones(toneConfig);
+    AdcToneDetector::Output tonePower;
+    printResult(runStage("adc_tones", iterations, [&](long i) {
+        int64_t timeUs[4];
+        for (int ch = 0; ch < 4; ++ch)
+            timeUs[ch] = i * 1400;
+        tones.push(&scans[(i % N_SCANS) * 4], timeUs, 4, 0xF, tonePower);
+        return tonePower.rms[0][0];
+    }), text);
+
+    // What each instrumented stage adds: a clock read and one histogram record.
+    LatencyHistogram histogram;
+    printResult(runStage("metrics_record", iterations, [&](long i) {
+        histogram.record(Metrics::nowNs() & 0xFFFFF);
+        return (double)i;
+    }), text);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+// lcas_tap: follows the frame bus from outside lcasd (or a standalone
+// thermal_gui) and prints every frame and/or ADC scan as CSV, oldest first,
+// reporting anything the ring overwrote before it was read. A starting point
+// for loggers and analysis tools; it needs nothing but the bus.
+//
+//   lcas_tap [frames|adc|all] [bus name]
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <csignal>
+#include <unistd.h>
+#include "FrameBus.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handleSignal(int) {
+    running = 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* mode = argc > 1 ? argv[1] : "all";
+    const char* name = argc > 2 ? argv[2] : FrameBus::DEFAULT_NAME;
+    bool frames = !strcmp(mode, "frames") || !strcmp(mode, "all");
+    bool adc = !strcmp(mode, "adc") || !strcmp(mode, "all");
+    if (!frames && !adc) {
+        fprintf(stderr, "usage: %s [frames|adc|all] [bus name]\n", argv[0]);
+        return 2;
+    }
+
+    FrameBus bus;
+    if (!bus.attach(name)) {
+        fprintf(stderr, "No frame bus at %s; is lcasd running?\n", name);
+        return 1;
+    }
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    // Start from the newest items rather than replaying the rings.
+    FrameBus::Cursor frameCursors[FrameBus::CAMERAS];
+    FrameBus::Cursor adcCursor;
+    ThermalFrame frame;
+    AdcSample sample;
+    for (int cam = 0; cam < FrameBus::CAMERAS; ++cam)
+        bus.latestFrame(cam, frameCursors[cam], frame);
+    bus.latestAdc(adcCursor, sample);
+
+    uint64_t lostFrames = 0, lostScans = 0;
+    while (running && bus.writerAlive()) {
+        bool idle = true;
+        for (int cam = 0; frames && cam < FrameBus::CAMERAS; ++cam) {
+            while (bus.nextFrame(cam, frameCursors[cam], frame)) {
+                idle = false;
+                printf("frame,%d,%llu,%lld,%d,%.1f,%.1f,%d\n", frame.camIndex,
+                       (unsigned long long)frame.seq, (long long)frame.timestampUs, frame.pecOk ? 1 : 0,
+                       frame.stats.min / 10.0, frame.stats.max / 10.0, frame.stats.overThreshold);
+            }
+        }
+        while (adc && bus.nextAdc(adcCursor, sample)) {
+            idle = false;
+            printf("adc,%llu,%lld,%u", (unsigned long long)sample.seq, (long long)sample.timeUs, sample.fresh);
+            for (int i = 0; i < sample.count; ++i)
+                printf(std::isnan(sample.volts[i]) ? ",nan" : ",%.7f", sample.volts[i]);
+            printf("\n");
+        }
+
+        uint64_t frameLoss = 0;
+        for (const FrameBus::Cursor& cursor : frameCursors)
+            frameLoss += cursor.lost;
+        if (frameLoss != lostFrames || adcCursor.lost != lostScans) {
+            fprintf(stderr, "lcas_tap: fell behind, %llu frames and %llu scans lost so far\n",
+                    (unsigned long long)frameLoss, (unsigned long long)adcCursor.lost);
+            lostFrames = frameLoss;
+            lostScans = adcCursor.lost;
+        }
+        if (idle) {
+            fflush(stdout);
+            usleep(adc ? 2000 : 20000);
+        }
+    }
+    if (running)
+        fprintf(stderr, "lcas_tap: the writer closed the bus\n");
+    return 0;
+}
@@ -0,0 +1,73 @@
+// lcasd: acquisition, interlocks and supplies without a window. Viewers
+// (thermal_gui) attach over the control socket and the frame bus; none of
+// them can stall or stop protection by crashing or going away.
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QDebug>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+#include "LcasCore.h"
+#include "LcasServer.h"
+#include "FrameBus.h"
+#include "MetricsServer.h"
+
+static int signalPipe[2] = {-1, -1};
+
+static void handleSignal(int) {
+    char byte = 0;
+    ssize_t ignored = write(signalPipe[1], &byte, 1);
+    (void)ignored;
+}
+
+int main(int argc, char *argv[]) {
+    qRegisterMetaType<ThermalFramePtr>("ThermalFramePtr");
+    QCoreApplication app(argc, argv);
+
+    // SIGINT/SIGTERM go through a pipe so teardown runs in the event loop.
+    if (pipe(signalPipe) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    QSocketNotifier signalNotifier(signalPipe[0], QSocketNotifier::Read);
+    QObject::connect(&signalNotifier, &QSocketNotifier::activated, &app, &QCoreApplication::quit);
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    const char* busName = getenv("LCAS_FRAME_BUS") ? getenv("LCAS_FRAME_BUS") : FrameBus::DEFAULT_NAME;
+    const char* socketName = getenv("LCAS_SOCKET") ? getenv("LCAS_SOCKET") : LcasServer::DEFAULT_NAME;
+
+    FrameBus frameBus;
+    if (!frameBus.create(busName))
+        fprintf(stderr, "lcasd: no frame bus, viewers will not see images\n");
+
+    LcasCore core;
+    core.configureFromEnvironment();
+    core.setFrameBus(frameBus.isOpen() ? &frameBus : nullptr);
+    QObject::connect(&core, &LcasLink::tripped, [](const QString& reason, qint64 latencyUs) {
+        qWarning() << "lcasd: trip:" << reason << "in" << latencyUs << "us";
+    });
+    QObject::connect(&core, &LcasLink::shutdownFinished, [](bool verified, qint64 totalUs) {
+        qWarning() << "lcasd: shutdown" << (verified ? "verified" : "NOT VERIFIED") << "in" << totalUs << "us";
+    });
+    QObject::connect(&core, &LcasLink::message, [](const QString& text) {
+        qWarning() << "lcasd:" << text;
+    });
+
+    LcasServer server(&core);
+    if (!server.listen(socketName))
+        return 1;
+    // Prometheus scrape target; LCAS_METRICS_PORT=0 turns it off.
+    MetricsServer metricsServer;
+    const char* metricsPort = getenv("LCAS_METRICS_PORT");
+    int port = metricsPort ? atoi(metricsPort) : MetricsServer::DEFAULT_PORT;
+    if (port > 0)
+        metricsServer.listen((quint16)port);
+    core.start();
+    qDebug() << "lcasd:" << core.describe();
+
+    int status = app.exec();
+    core.stop();
+    return status;
+}
@@ -1,16 +1,68 @@
 #include <QApplication>
 #include <QMetaType>
+#include <QDebug>
+#include <cstdlib>
+#include <memory>
 #include "mainwindow.h"
-#include "ThermalCameraManager.h"
-
-ThermalCameraManager thermalManager;
+#include "LcasCore.h"
+#include "LcasClient.h"
+#include "LcasServer.h"
+#include "FrameBus.h"
+#include "MetricsServer.h"
 
 int main(int argc, char *argv[]) {
-    qRegisterMetaType<cv::Mat>("cv::Mat");
+    qRegisterMetaType<ThermalFramePtr>("ThermalFramePtr");
     QApplication app(argc, argv);
 
-    MainWindow window;
+    // Attach to lcasd when it is running, so closing or crashing the window
+    // leaves protection alone. Only when no daemon exists (or with
+    // LCAS_STANDALONE set) does the GUI run acquisition itself as before; a
+    // daemon that is slow or refuses us may still own the hardware, so then
+    // the GUI stays detached and keeps retrying.
+    const char* busName = getenv("LCAS_FRAME_BUS") ? getenv("LCAS_FRAME_BUS") : FrameBus::DEFAULT_NAME;
+    FrameBus frameBus;
+    std::unique_ptr<LcasClient> client;
+    std::unique_ptr<LcasCore> core;
+    LcasLink* link = nullptr;
+    if (!getenv("LCAS_STANDALONE")) {
+        const char* socketName = getenv("LCAS_SOCKET") ? getenv("LCAS_SOCKET") : LcasServer::DEFAULT_NAME;
+        client.reset(new LcasClient());
+        QLocalSocket::LocalSocketError error = QLocalSocket::UnknownSocketError;
+        bool attached = client->connectToDaemon(socketName, busName, 500, &error);
+        if (attached || error != QLocalSocket::ServerNotFoundError) {
+            if (!attached)
+                qWarning() << "Cannot attach to lcasd at" << socketName << ":" << error
+                           << "- staying detached; set LCAS_STANDALONE to run without it";
+            link = client.get();
+        } else {
+            client.reset();
+        }
+    }
+    if (!link) {
+        core.reset(new LcasCore());
+        core->configureFromEnvironment();
+        // Loggers and tools can still follow acquisition through the bus.
+        if (frameBus.create(busName))
+            core->setFrameBus(&frameBus);
+        link = core.get();
+    }
+
+    // Standalone, the GUI has every stage and takes lcasd's port. Attached,
+    // it only has render and delivery times, served on a port of its own.
+    MetricsServer metricsServer;
+    const char* metricsPort = getenv(core ? "LCAS_METRICS_PORT" : "LCAS_GUI_METRICS_PORT");
+    int port = metricsPort ? atoi(metricsPort) : core ? MetricsServer::DEFAULT_PORT : 0;
+    if (port > 0)
+        metricsServer.listen((quint16)port);
+
+    MainWindow window(link);
     window.show();
+    if (core)
+        core->start();
+    qDebug() << "Acquisition:" << link->describe();
 
-    return app.exec();
+    int status = app.exec();
+    if (core)
+        core->stop();
+    return status;
 }
@@ -1,52 +1,45 @@
 #include "mainwindow.h"
+#include "Metrics.h"
 #include <QPixmap>
 #include <QImage>
 #include <QTimer>
-#include <QProcess>
 #include <QLCDNumber>
+#include <QSignalBlocker>
 #include <QDebug>
-#include <QThread>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <stdlib.h>
+#include <cmath>
 
-extern ThermalCameraManager thermalManager;
-
-MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), updateTimer(new QTimer(this)) {
+MainWindow::MainWindow(LcasLink* link, QWidget* parent)
+    : QMainWindow(parent), ui(new Ui::MainWindow), updateTimer(new QTimer(this)), link(link) {
     ui->setupUi(this);
-    thermalManager.initialize();
-
-    double initialThreshold = thermalManager.getThreshold();
-    ui->doubleSpinBox_TempSet->setValue(initialThreshold);
-    ui->lcdNumber_temp->display(initialThreshold);
-
-
-    for (int i = 0; i < 4; ++i) {
-    thermalThreads[i] = new QThread(this);
-    thermalWorkers[i] = new ThermalWorker(i);
-    thermalWorkers[i]->moveToThread(thermalThreads[i]);
-
-    // When the thread starts, start that worker’s timer
-    thermalThreads[i]->start();
-
-    // Safely invoke `start()` *in the worker thread's context*
-    QMetaObject::invokeMethod(thermalWorkers[i], "start", Qt::QueuedConnection);
+    colorizer.setRange(ThermalColorizer::rangeFromString(getenv("LCAS_THERMAL_RANGE")));
+
+    // Thresholds live with the link; the spin boxes request changes and
+    // show whatever is actually in force.
+    handleThresholdsChanged();
+    connect(link, &LcasLink::thresholdsChanged, this, &MainWindow::handleThresholdsChanged);
+    QDoubleSpinBox* adcThresholds[4] = {ui->doubleSpinBox, ui->doubleSpinBox_2,
+                                        ui->doubleSpinBox_3, ui->doubleSpinBox_4};
+    for (int i = 0; i < 4; ++i)
+        connect(adcThresholds[i], QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, [this, i](double val) { this->link->setAdcThreshold(i, val); });
+    connect(ui->doubleSpinBox_TempSet, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, [this](double val) { this->link->setTemperatureThreshold(val); });
 
+    supplyReadout = new QLabel(this);
+    ui->statusbar->addPermanentWidget(supplyReadout);
 
-    connect(thermalWorkers[i], &ThermalWorker::frameReady,
-            this, &MainWindow::handleThermalFrame);
+    connect(link, &LcasLink::frameReady, this, &MainWindow::handleThermalFrame);
+    connect(link, &LcasLink::tripped, this, &MainWindow::handleSafetyTrip);
+    connect(link, &LcasLink::shutdownFinished, this, &MainWindow::handleShutdownFinished);
+    connect(link, &LcasLink::supplyTelemetry, this, &MainWindow::handleSupplyTelemetry);
+    connect(link, &LcasLink::seedChanged, this, &MainWindow::handleSeedChanged);
+    connect(link, &LcasLink::message, this, [this](const QString& text) {
+        ui->statusbar->showMessage(text);
+    });
 
-    thermalThreads[i]->start();
-    }
-    
-    connect(ui->doubleSpinBox_TempSet, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
-        this, [this](double val) {
-            thermalManager.setThreshold(val);
-            ui->lcdNumber_temp->display(val);
-            qDebug() << "Temperature threshold set to" << val;
-        });
-        
     connect(ui->doubleSpinBox_Vset, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
         this, &MainWindow::handleVoltageChanged);
     connect(ui->doubleSpinBox_Iset, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
@@ -68,26 +61,11 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(ui->powerShutdownTriggerReset, &QPushButton::clicked, this, &MainWindow::powerShutdownTriggerReset);
 
-    adcProcess = new QProcess(this);
-    adcProcess->setProgram("python3");
-    adcProcess->setArguments(QStringList() << "/home/admin/Desktop/LCAS-Project-main/LCAS-Interface/readadcsimple.py");
-    adcProcess->setProcessChannelMode(QProcess::MergedChannels); // Merge stdout + stderr
-    connect(adcProcess, &QProcess::readyReadStandardOutput, this, &MainWindow::handleADCOutput);
-    adcProcess->start();
-
-    powerSerial = new QSerialPort(this);
-    powerSerial->setPortName("/dev/ttyUSB0");  
-    powerSerial->setBaudRate(QSerialPort::Baud9600);  
-    powerSerial->setDataBits(QSerialPort::Data8);
-    powerSerial->setParity(QSerialPort::NoParity);
-    powerSerial->setStopBits(QSerialPort::OneStop);
-    powerSerial->setFlowControl(QSerialPort::NoFlowControl);
-    if (powerSerial->open(QIODevice::ReadWrite)) {
-    qDebug() << "Power serial port opened successfully.";
-    } else {
-    qDebug() << "Failed to open power serial port:" << powerSerial->errorString();
-    }
-
+    // The LCDs are refreshed from the latest scan.
+    adcReadout = new QLabel(this);
+    ui->statusbar->addPermanentWidget(adcReadout);
+    connect(updateTimer, &QTimer::timeout, this, &MainWindow::updateAdcDisplay);
+    updateTimer->start(100);
 
     label_cam0 = new QLabel(ui->frame);
     label_cam1 = new QLabel(ui->frame_2);
@@ -100,42 +78,25 @@ MainWindow::MainWindow(QWidget* parent)
         label->setMinimumSize(200, 200);  
         label->setScaledContents(false);  
     }
-    
-    // enable pin 12 for seed power supply control
-    system("gpio -g mode 12 out");
-    system("gpio -g write 12 0");
-
 }
 
 MainWindow::~MainWindow() {
-    for (int i = 0; i < 4; ++i) {
-        thermalThreads[i]->quit();
-        thermalThreads[i]->wait();
-        delete thermalWorkers[i];
-        delete thermalThreads[i];
-    }
-}
-
-
-static QImage matToQImage(const cv::Mat& mat) {
-    cv::Mat rgb;
-    if (mat.channels() == 1) {
-        cv::cvtColor(mat, rgb, cv::COLOR_GRAY2RGB);
-    } else {
-        cv::cvtColor(mat, rgb, cv::COLOR_BGR2RGB);
-    }
-    return QImage(rgb.data, rgb.cols, rgb.rows, rgb.step, QImage::Format_RGB888).copy();
 }
 
 
-void MainWindow::handleThermalFrame(int camIndex, const cv::Mat& frame, bool thresholdExceeded) {
+void MainWindow::handleThermalFrame(const ThermalFramePtr& frame) {
+    // Capture to here: the queued signal, or the frame bus poll when attached to lcasd.
+    int64_t startNs = Metrics::nowNs();
+    metrics.record(Metrics::Stage::SignalDelivery, startNs - frame->timestampUs * 1000);
+    const int camIndex = frame->camIndex;
+    const FrameStats& stats = frame->stats;
     //qDebug() << "handleThermalFrame called for cam" << camIndex;
 
-    if (thresholdExceeded && !powerShutdownTriggered) {
-        //powerShutdownTriggered = true;
-        //qDebug() << "Thermal threshold exceeded on camera" << camIndex << " — triggering emergency stop.";
-        QMetaObject::invokeMethod(this, "handleEmergencyStop", Qt::QueuedConnection);
-        return;
+    // SafetyEngine has already acted on this frame; only report it here.
+    if (stats.exceeded() && !powerShutdownTriggered) {
+        ui->statusbar->showMessage(QString("Camera %1: %2 px over threshold, max %3 C at (%4, %5)")
+                                   .arg(camIndex).arg(stats.overThreshold).arg(stats.max / 10.0, 0, 'f', 1)
+                                   .arg(stats.maxX).arg(stats.maxY));
     }
     /*
     static int frameCounters[4] = {0};
@@ -160,92 +121,47 @@ void MainWindow::handleThermalFrame(int camIndex, const cv::Mat& frame, bool thr
         return;
     }
 
-    QImage image = matToQImage(frame);
-    QPixmap pixmap = QPixmap::fromImage(image).scaled(
-        targetLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    targetLabel->setPixmap(pixmap);
+    const QImage& scaled = upscalers[camIndex].scale(colorizer.render(*frame), targetLabel->size());
+    targetLabel->setPixmap(QPixmap::fromImage(scaled));
+    metrics.record(Metrics::Stage::Render, Metrics::nowNs() - startNs);
     //qDebug() << "Displayed frame for cam" << camIndex
     //         << " size:" << frame.cols << "x" << frame.rows;
 }
 
 
 
-void MainWindow::handleADCOutput() {
-    while (adcProcess->canReadLine()) {
-        QByteArray line = adcProcess->readLine().trimmed();
-        QList<QByteArray> values = line.split(',');
-
-        if (values.size() >= 4) {
-            bool ok[4];
-            double val[4] = {
-                values[0].toDouble(&ok[0]),
-                values[1].toDouble(&ok[1]),
-                values[2].toDouble(&ok[2]),
-                values[3].toDouble(&ok[3])
-            };
-
-            if (ok[0]) ui->lcdNumber->display(val[0]);
-            if (ok[1]) ui->lcdNumber_2->display(val[1]);
-            if (ok[2]) ui->lcdNumber_3->display(val[2]);
-            if (ok[3]) ui->lcdNumber_4->display(val[3]);
-
-            // Check thresholds for all 4 channels
-            for (int i = 0; i < 4; ++i) {
-                if (!ok[i]) continue;
-
-                double threshold = 0.0;
-                switch (i) {
-                    case 0: threshold = ui->doubleSpinBox->value(); break;
-                    case 1: threshold = ui->doubleSpinBox_2->value(); break;
-                    case 2: threshold = ui->doubleSpinBox_3->value(); break;
-                    case 3: threshold = ui->doubleSpinBox_4->value(); break;
-                }
-
-                if (val[i] > threshold && !powerShutdownTriggered) {
-                    powerShutdownTriggered = true;
-                    ui->TriggerIndicator->setStyleSheet("background-color: red; border: 1px solid black;");
-                    qDebug() << QString("ADC channel %1 exceeded threshold (%2 > %3). Triggering emergency stop.")
-                                .arg(i).arg(val[i]).arg(threshold);
-                    handleEmergencyStop();
-                    break;
-                }
-            }
-        }
-    }
-}
-
-void MainWindow::sendCommandToPowerSupply(const QString& address, const QString& command) {
-    if (powerSerial && powerSerial->isOpen()) {
-        QByteArray adrCmd = QString("ADR %1\r").arg(address).toUtf8();
-        QByteArray mainCmd = command.toUtf8();
-
-        powerSerial->write(adrCmd);
-        powerSerial->waitForBytesWritten(50);
-        QThread::msleep(100);
+void MainWindow::updateAdcDisplay() {
+    FrameBus::AdcStatus status;
+    if (!link->latestAdc(status))
+        return;
+    const AdcSample& sample = status.sample;
 
-        powerSerial->write(mainCmd);
-        powerSerial->waitForBytesWritten(50);
+    QLCDNumber* lcds[4] = {ui->lcdNumber, ui->lcdNumber_2, ui->lcdNumber_3, ui->lcdNumber_4};
+    for (int i = 0; i < sample.count && i < 4; ++i)
+        if (!std::isnan(sample.volts[i]))
+            lcds[i]->display(sample.volts[i]);
 
-        qDebug() << "Sent to PS" << address << ":" << command.trimmed();
-    } else {
-        qDebug() << "Serial port not open — cannot send command to PS" << address;
-    }
+    // Achieved per-channel rates, once a second.
+    if (++adcTicks % 10 != 0)
+        return;
+    QString rates;
+    for (int i = 0; i < sample.count; ++i)
+        rates += QString(i ? "/%1" : "%1").arg(status.channelRate[i], 0, 'f', 0);
+    adcReadout->setText(QString("ADC %1 S/s").arg(rates));
 }
 
-
 void MainWindow::handleVoltageChanged(double voltage) {
-    sendCommandToPowerSupply("06", QString("PV %1\r").arg(voltage, 0, 'f', 2));
+    link->setVoltage("06", voltage);
 }
 
 void MainWindow::handleCurrentChanged(double current) {
-    sendCommandToPowerSupply("06", QString("PC %1\r").arg(current, 0, 'f', 2));
+    link->setCurrent("06", current);
 }
 
 void MainWindow::handleToggleOutput() {
     static bool outputOn1 = false;
     outputOn1 = !outputOn1;
-    sendCommandToPowerSupply("06", QString("OUT %1\r").arg(outputOn1 ? 1 : 0));
+    link->enableOutput("06", outputOn1);
 
     QString style = outputOn1
         ? "background-color: green; border: 1px solid black;"
@@ -254,17 +170,23 @@ void MainWindow::handleToggleOutput() {
 }
 
 void MainWindow::handleVoltageChanged2(double voltage) {
-    sendCommandToPowerSupply("07", QString("PV %1\r").arg(voltage, 0, 'f', 2));
+    link->setVoltage("07", voltage);
 }
 
 void MainWindow::handleCurrentChanged2(double current) {
-    sendCommandToPowerSupply("07", QString("PC %1\r").arg(current, 0, 'f', 2));
+    link->setCurrent("07", current);
+}
+
+void MainWindow::handleSupplyTelemetry(const QString& address, double volts, double amps) {
+    QString& text = address == "06" ? supplyText[0] : supplyText[1];
+    text = QString("PS %1: %2 V %3 A").arg(address).arg(volts, 0, 'f', 2).arg(amps, 0, 'f', 2);
+    supplyReadout->setText(supplyText[0] + "   " + supplyText[1]);
 }
 
 void MainWindow::handleToggleOutput2() {
     static bool outputOn2 = false;
     outputOn2 = !outputOn2;
-    sendCommandToPowerSupply("07", QString("OUT %1\r").arg(outputOn2 ? 1 : 0));
+    link->enableOutput("07", outputOn2);
 
     QString style = outputOn2
         ? "background-color: green; border: 1px solid black;"
@@ -273,52 +195,68 @@ void MainWindow::handleToggleOutput2() {
 }
 
 void MainWindow::handleEmergencyStop() {
-    qDebug() << "Emergency stop activated! Shutting down power supplies.";
-
-    // === PS2 FIRST ===
-    sendCommandToPowerSupply("07", "PC 0\r");
-    QThread::msleep(50);
-    sendCommandToPowerSupply("07", "PV 0\r");
-    QThread::msleep(50);
-    sendCommandToPowerSupply("07", "OUT 0\r");
-    QThread::msleep(100); // Final pause
+    // Runs in the supply thread; handleShutdownFinished updates the UI.
+    link->emergencyStop();
+}
 
+void MainWindow::handleShutdownFinished(bool verified, qint64 totalUs) {
     ui->doubleSpinBox_Vset->setValue(0.0);
     ui->doubleSpinBox_Iset->setValue(0.0);
-
-    // === PS1 SECOND ===
-    sendCommandToPowerSupply("06", "PC 0\r");
-    QThread::msleep(50);
-    sendCommandToPowerSupply("06", "PV 0\r");
-    QThread::msleep(50);
-    sendCommandToPowerSupply("06", "OUT 0\r");
-
     ui->doubleSpinBox_Vset_2->setValue(0.0);
     ui->doubleSpinBox_Iset_2->setValue(0.0);
 
-    // SEED PS LAST
-
-    system("gpio -g write 12 1");
-
     // Update visual output indicators
     ui->OutIndicatorFrame->setStyleSheet("background-color: red; border: 1px solid black;");
     ui->OutIndicatorFrame_2->setStyleSheet("background-color: red; border: 1px solid black;");
     ui->OutIndicatorFrame_3->setStyleSheet("background-color: red; border: 1px solid black;");
 
-    qDebug() << "Emergency shutdown complete.";
+    QString summary = QString("Emergency shutdown %1 in %2 ms")
+                          .arg(verified ? "complete" : "NOT VERIFIED").arg(totalUs / 1000.0, 0, 'f', 1);
+    ui->statusbar->showMessage(summary);
+    qDebug() << summary;
 }
 
 void MainWindow::SeedLock() {
-    system("gpio -g write 12 1");
-    ui->OutIndicatorFrame_3->setStyleSheet("background-color: red; border: 1px solid black;");
+    link->setSeedLocked(true);
 }
 
 void MainWindow::SeedUnlock() {
-    system("gpio -g write 12 0");
-    ui->OutIndicatorFrame_3->setStyleSheet("background-color: green; border: 1px solid black;");
+    link->setSeedLocked(false);
+}
+
+void MainWindow::handleSeedChanged(bool locked, bool ok) {
+    if (!ok) {
+        ui->statusbar->showMessage(locked ? "Seed lock line did not read back high"
+                                          : "Seed unlock failed; seed stays locked");
+        // A failed lock is still shown as locked; a failed unlock changes nothing.
+        if (!locked)
+            return;
+    }
+    ui->OutIndicatorFrame_3->setStyleSheet(locked ? "background-color: red; border: 1px solid black;"
+                                                  : "background-color: green; border: 1px solid black;");
+}
+
+void MainWindow::handleSafetyTrip(const QString& reason, qint64 latencyUs) {
+    powerShutdownTriggered = true;
+    ui->TriggerIndicator->setStyleSheet("background-color: red; border: 1px solid black;");
+    ui->statusbar->showMessage(QString("%1 (tripped in %2 ms)").arg(reason).arg(latencyUs / 1000.0, 0, 'f', 2));
+    qDebug() << reason << "- triggering emergency stop.";
 }
 
 void MainWindow::powerShutdownTriggerReset() {
     powerShutdownTriggered = false;
+    link->resetTrip();
     ui->TriggerIndicator->setStyleSheet("background-color: green; border: 1px solid black;");
-}
\ No newline at end of file
+}
+
+void MainWindow::handleThresholdsChanged() {
+    QDoubleSpinBox* adcThresholds[4] = {ui->doubleSpinBox, ui->doubleSpinBox_2,
+                                        ui->doubleSpinBox_3, ui->doubleSpinBox_4};
+    for (int i = 0; i < 4; ++i) {
+        QSignalBlocker blocker(adcThresholds[i]);
+        adcThresholds[i]->setValue(link->adcThreshold(i));
+    }
+    QSignalBlocker blocker(ui->doubleSpinBox_TempSet);
+    ui->doubleSpinBox_TempSet->setValue(link->temperatureThreshold());
+    ui->lcdNumber_temp->display(link->temperatureThreshold());
+}
@@ -3,22 +3,22 @@
 #include <QMainWindow>
 #include <QTimer>
 #include <QLabel>
-#include <QProcess>
-#include <QSerialPort>
 #include "LCASGUIV2.h"
-#include "ThermalCameraManager.h"
-#include "ThermalWorker.h"
+#include "LcasLink.h"
+#include "ThermalColorizer.h"
+#include "ThermalUpscaler.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget* parent = nullptr);
+    // The window only displays and commands; link owns the hardware.
+    MainWindow(LcasLink* link, QWidget* parent = nullptr);
     ~MainWindow();
 
 private slots:
 
-    void handleThermalFrame(int camIndex, const cv::Mat& frame, bool thresholdExceeded);
+    void handleThermalFrame(const ThermalFramePtr& frame);
 
     void handleVoltageChanged(double);
     void handleCurrentChanged(double);
@@ -34,27 +34,32 @@ private slots:
     void SeedUnlock();
 
     void powerShutdownTriggerReset();
+    void handleSafetyTrip(const QString& reason, qint64 latencyUs);
+    void handleShutdownFinished(bool verified, qint64 totalUs);
+    void handleSupplyTelemetry(const QString& address, double volts, double amps);
+    void handleThresholdsChanged();
+    void handleSeedChanged(bool locked, bool ok);
 
 private:
     Ui::MainWindow *ui;
     QTimer* updateTimer;
-    
-
-    QThread* thermalThreads[4];
-    ThermalWorker* thermalWorkers[4];
+    LcasLink* link;
 
     QLabel* label_cam0;
     QLabel* label_cam1;
     QLabel* label_cam2;
     QLabel* label_cam3;
 
-    QProcess* adcProcess;           // Process to run the ADC Python script
-    void handleADCOutput();         // Slot to handle new ADC data
+    ThermalColorizer colorizer;
+    ThermalUpscaler upscalers[4];
 
-    QSerialPort* powerSerial;
-    bool powerShutdownTriggered = false;
+    void updateAdcDisplay();        // Shows the latest stray-light scan
+    QLabel* adcReadout;
+    int adcTicks = 0;
 
-    void sendCommandToPowerSupply(const QString& address, const QString& command);
+    QLabel* supplyReadout;
+    QString supplyText[2];
+    bool powerShutdownTriggered = false;
 
 
 };
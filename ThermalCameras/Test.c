@@ -9,6 +9,7 @@
 #include <linux/i2c-dev.h>
 #include <signal.h>
 #include <time.h>
+#include "../LCAS-Interface/Crc8.h"
 #include <gpiod.h>
 
 #define D6T_ADDR      0x0A      // Melexis D6T fixed address
@@ -44,18 +45,8 @@ int i2c_read_reg(int fd, uint8_t reg, uint8_t *buf, size_t len) {
     if (read(fd, buf, len) != (ssize_t)len) return -1;
     return 0;
 }
-// CRC-8 PEC
-uint8_t calc_crc(uint8_t data) {
-    for (int i = 0; i < 8; i++) {
-        uint8_t temp = data;
-        data <<= 1;
-        if (temp & 0x80) data ^= 0x07;
-    }
-    return data;
-}
 bool D6T_checkPEC(const uint8_t buf[], int n) {
-    uint8_t crc = calc_crc((D6T_ADDR << 1) | 1);
-    for (int i = 0; i < n; i++) crc = calc_crc(buf[i] ^ crc);
+    uint8_t crc = crc8_update(crc8_byte(0, (D6T_ADDR << 1) | 1), buf, n);
     if (crc != buf[n]) {
         fprintf(stderr, "PEC failed: calc=0x%02X got=0x%02X\n", crc, buf[n]);
         return true;
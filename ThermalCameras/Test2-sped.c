@@ -12,6 +12,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <time.h>
+#include "../LCAS-Interface/Crc8.h"
 #include <thread>
 #include <atomic>
 #include <array>
@@ -44,19 +45,8 @@ std::array<cv::Mat,4> frames;
 std::array<std::mutex,4> frame_mutex;
 std::atomic<bool> running{true};
 
-uint8_t calc_crc(uint8_t data) {
-    for (int i = 0; i < 8; ++i) {
-        if (data & 0x80) data = (data << 1) ^ 0x07;
-        else data <<= 1;
-    }
-    return data;
-}
-
 bool D6T_checkPEC(uint8_t buf[], int n) {
-    uint8_t crc = calc_crc((D6T_ADDR << 1) | 1);
-    for (int i = 0; i < n; i++) {
-        crc = calc_crc(buf[i] ^ crc);
-    }
+    uint8_t crc = crc8_update(crc8_byte(0, (D6T_ADDR << 1) | 1), buf, n);
     if (crc != buf[n]) {
         fprintf(stderr, "PEC check failed: %02X != %02X\n", crc, buf[n]);
         return false;
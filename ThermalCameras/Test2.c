@@ -13,6 +13,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <time.h>
+#include "../LCAS-Interface/Crc8.h"
 
 #define D6T_ADDR 0x0A
 #define D6T_CMD 0x4D
@@ -39,19 +40,8 @@ void delay(int ms) {
     nanosleep(&ts, NULL);
 }
 
-uint8_t calc_crc(uint8_t data) {
-    for (int i = 0; i < 8; ++i) {
-        if (data & 0x80) data = (data << 1) ^ 0x07;
-        else data <<= 1;
-    }
-    return data;
-}
-
 bool D6T_checkPEC(uint8_t buf[], int n) {
-    uint8_t crc = calc_crc((D6T_ADDR << 1) | 1);
-    for (int i = 0; i < n; i++) {
-        crc = calc_crc(buf[i] ^ crc);
-    }
+    uint8_t crc = crc8_update(crc8_byte(0, (D6T_ADDR << 1) | 1), buf, n);
     bool failed = crc != buf[n];
     if (failed) fprintf(stderr, "PEC check failed: %02X != %02X\n", crc, buf[n]);
     return failed;